@@ -0,0 +1,34 @@
+# Generate src/space/DefaultScenes.h from data/scenes.json, so the built in
+# scenes are always the ones uploaded to SPIFFS. Runs before every build and
+# only rewrites the header when the scenes changed.
+import os
+
+try:
+    Import("env")
+    root = env.subst("$PROJECT_DIR")
+except NameError:
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+source = os.path.join(root, "data", "scenes.json")
+target = os.path.join(root, "src", "space", "DefaultScenes.h")
+
+with open(source) as f:
+    scenes = f.read().rstrip("\n")
+if ')"' in scenes:
+    raise SystemExit("data/scenes.json: )\" ends the raw string literal")
+
+header = """// Generated by scripts/scenes.py from data/scenes.json, do not edit
+#ifndef DEFAULT_SCENES_H
+#define DEFAULT_SCENES_H
+// Built in scenes, used when there is no valid data/scenes.json on SPIFFS
+static const char DEFAULT_SCENES[] = R"({})";
+#endif
+""".format(scenes)
+
+old = None
+if os.path.exists(target):
+    with open(target) as f:
+        old = f.read()
+if old != header:
+    with open(target, "w") as f:
+        f.write(header)
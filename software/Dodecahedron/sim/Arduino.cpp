@@ -0,0 +1,63 @@
+#include "Arduino.h"
+
+#include <stdarg.h>
+
+#include <chrono>
+#include <random>
+#include <thread>
+/*------------------------------------------------------------------------------
+ * Arduino stand-in for the native simulator
+ *----------------------------------------------------------------------------*/
+HardwareSerial Serial;
+EspClass ESP;
+
+static bool virtual_enabled = false;
+static uint64_t virtual_now = 0;
+static std::minstd_rand generator;
+
+static uint64_t host_micros() {
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void sim::virtual_clock(bool enable) { virtual_enabled = enable; }
+void sim::advance(uint32_t us) { virtual_now += us; }
+
+unsigned long micros() {
+  return virtual_enabled ? virtual_now : host_micros();
+}
+unsigned long millis() { return micros() / 1000; }
+void delay(uint32_t ms) {
+  if (virtual_enabled)
+    virtual_now += ms * 1000ULL;
+  else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+long random(long max) { return random(0, max); }
+long random(long min, long max) {
+  if (max <= min) return min;
+  return min + generator() % (max - min);
+}
+void randomSeed(unsigned long seed) { generator.seed(seed); }
+
+uint32_t getCpuFrequencyMhz() { return 240; }
+// Cycles always follow the host clock, the virtual clock does not run while
+// a frame renders
+uint32_t EspClass::getCycleCount() {
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+             .count() *
+         getCpuFrequencyMhz() / 1000;
+}
+
+int HardwareSerial::printf(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  int n = vprintf(format, args);
+  va_end(args);
+  return n;
+}
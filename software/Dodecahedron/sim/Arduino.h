@@ -0,0 +1,51 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+/*------------------------------------------------------------------------------
+ * Arduino stand-in for the native simulator
+ *------------------------------------------------------------------------------
+ * Provides only the Arduino and FreeRTOS calls the animation code uses. Time
+ * comes from a virtual clock when the simulator enables it, so every frame can
+ * be given the same dt regardless of how long it took to render.
+ *----------------------------------------------------------------------------*/
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "freertos.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long micros();
+unsigned long millis();
+void delay(uint32_t ms);
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+// Cpu clock of an ESP32, cycle counts are scaled from the host clock
+uint32_t getCpuFrequencyMhz();
+
+// Virtual clock control, only available in the simulator
+namespace sim {
+// Use the virtual clock instead of the host clock
+void virtual_clock(bool enable);
+// Advance the virtual clock
+void advance(uint32_t us);
+}  // namespace sim
+
+class EspClass {
+ public:
+  uint32_t getCycleCount();
+};
+extern EspClass ESP;
+
+class HardwareSerial {
+ public:
+  void begin(unsigned long) {}
+  int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+  void print(const char *s) { printf("%s", s); }
+  void println(const char *s) { printf("%s\n", s); }
+};
+extern HardwareSerial Serial;
+#endif
@@ -0,0 +1,124 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <chrono>
+#include <new>
+
+#include "core/Display.h"
+#include "core/Layer.h"
+#include "main.h"
+#include "power/Arena.h"
+#include "power/Math3D.h"
+#include "power/Noise.h"
+#include "power/Profiler.h"
+#include "space/Animation.h"
+#include "space/Palettes.h"
+#include "space/Scenes.h"
+/*------------------------------------------------------------------------------
+ * Benchmark suite for the native simulator
+ *----------------------------------------------------------------------------*/
+// Heap allocations of the whole program
+static std::atomic<uint32_t> allocations(0);
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size ? size : 1);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// Keeps the compiler from optimizing benchmarked calls away
+static volatile float sink_float;
+static volatile uint8_t sink_byte;
+
+static double now() {
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Time n calls of f, prints the nanoseconds per call
+template <class F>
+static void measure(const char *name, uint32_t n, F f) {
+  double start = now();
+  for (uint32_t i = 0; i < n; i++) f(i);
+  printf("%-24s ns/op=%.1f\n", name, (now() - start) / n);
+}
+
+static void scene(Scenes::list_t list, uint8_t index, uint32_t frames,
+                  unsigned long seed) {
+  randomSeed(seed);
+  Animation::start(list, index);
+  uint32_t allocated = allocations;
+  uint32_t leased = Arena::used();
+  double start = now();
+  for (uint32_t frame = 0; frame < frames; frame++) {
+    sim::advance(1000000 / 60);
+    Animation::animate();
+    Profiler::drain();
+  }
+  Display::flush();
+  double ns = now() - start;
+  printf("%-8s %2u  ns/frame=%8.0f  allocs=%u  arena=%u\n",
+         list == Scenes::SEQUENCE ? "sequence" : "select", index, ns / frames,
+         (unsigned)(allocations - allocated), (unsigned)leased);
+}
+
+int sim::benchmark(uint32_t frames, unsigned long seed) {
+  sim::virtual_clock(true);
+  Animation::begin();
+  printf("scenes, %u frames at 60 fps\n", (unsigned)frames);
+  for (uint8_t i = 0; i < Scenes::size(Scenes::SEQUENCE); i++) {
+    scene(Scenes::SEQUENCE, i, frames, seed);
+  }
+  for (uint8_t i = 0; i < Scenes::size(Scenes::SELECT); i++) {
+    scene(Scenes::SELECT, i, frames, seed);
+  }
+
+  printf("primitives\n");
+  static Noise noise;
+  measure("Noise::noise3", 1000000, [](uint32_t i) {
+    sink_float = noise.noise3(i * 0.01f, i * 0.02f, i * 0.03f);
+  });
+  Vector3 axis(0, 1, 0), v(0.5f, 0.2f, 0.1f);
+  measure("Vector3::rotate", 1000000, [&](uint32_t i) {
+    sink_float = axis.rotate(i * 0.1f, v).x;
+  });
+  Quaternion q(axis, 30);
+  // Inputs depend on i so the work cannot be hoisted out of the loop
+  measure("Quaternion::rotate", 1000000, [&](uint32_t i) {
+    sink_float = q.rotate(Vector3(i * 0.001f, 0.2f, 0.1f)).x;
+  });
+  Matrix3 m(q);
+  measure("Matrix3 * Vector3", 1000000, [&](uint32_t i) {
+    sink_float = (m * Vector3(i * 0.001f, 0.2f, 0.1f)).x;
+  });
+  static Palettes palettes;
+  CRGBPalette16 palette = palettes.get_palette(0);
+  measure("ColorFromPalette", 1000000, [&](uint32_t i) {
+    sink_byte = ColorFromPalette(palette, i, 255).r;
+  });
+  measure("Display::fade", 10000, [](uint32_t) { Display::fade(8); });
+  measure("Display::rotate", 1000, [&](uint32_t i) {
+    Display::rotate(Quaternion(axis, i * 0.1f));
+  });
+  // Static pixels, the arena still holds the last scene
+  static CRGB pixels[3][Display::PIXELS];
+  static Layer layers[3];
+  Layer *stack[] = {&layers[0], &layers[1], &layers[2]};
+  for (uint8_t l = 0; l < 3; l++) layers[l].leds = pixels[l];
+  layers[1].blend = blend_t::MAX;
+  layers[2].blend = blend_t::ALPHA;
+  layers[2].opacity = 128;
+  measure("Layer::composite 3", 10000, [&](uint32_t) {
+    Layer::composite(stack, 3, Display::leds);
+  });
+  measure("Display::update", 1000, [](uint32_t i) {
+    Display::leds[i % Display::PIXELS] = CRGB(i, i, i);
+    Display::update();
+  });
+  Display::flush();
+  return 0;
+}
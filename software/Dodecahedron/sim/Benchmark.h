@@ -0,0 +1,17 @@
+#ifndef SIM_BENCHMARK_H
+#define SIM_BENCHMARK_H
+#include <stdint.h>
+/*------------------------------------------------------------------------------
+ * Benchmark suite for the native simulator
+ *------------------------------------------------------------------------------
+ * Runs every scene of both scene lists for a fixed amount of frames on the
+ * virtual clock, each from the same seed, and reports the host time per
+ * frame, heap allocations and arena use. Then times the math, noise, palette
+ * and display primitives the effects are built from.
+ *
+ * pio run -e native && .pio/build/native/program -b [-n frames] [-r seed]
+ *----------------------------------------------------------------------------*/
+namespace sim {
+int benchmark(uint32_t frames, unsigned long seed);
+}  // namespace sim
+#endif
@@ -0,0 +1,71 @@
+#include "FastLED.h"
+/*------------------------------------------------------------------------------
+ * FastLED stand-in for the native simulator
+ *----------------------------------------------------------------------------*/
+CFastLED FastLED;
+
+// Spectrum hsv to rgb, hue 0..255 covers six 43 step sectors
+CRGB::CRGB(const CHSV &hsv) {
+  uint8_t sector = hsv.h / 43;
+  uint8_t rest = (hsv.h - sector * 43) * 6;
+  uint8_t p = scale8(hsv.v, 255 - hsv.s);
+  uint8_t q = scale8(hsv.v, 255 - scale8(hsv.s, rest));
+  uint8_t t = scale8(hsv.v, 255 - scale8(hsv.s, 255 - rest));
+  switch (sector) {
+    case 0: r = hsv.v, g = t, b = p; break;
+    case 1: r = q, g = hsv.v, b = p; break;
+    case 2: r = p, g = hsv.v, b = t; break;
+    case 3: r = p, g = q, b = hsv.v; break;
+    case 4: r = t, g = p, b = hsv.v; break;
+    default: r = hsv.v, g = p, b = q; break;
+  }
+}
+
+void fadeToBlackBy(CRGB *leds, uint16_t num_leds, uint8_t fade) {
+  for (uint16_t i = 0; i < num_leds; i++) leds[i].fadeToBlackBy(fade);
+}
+void fill_solid(CRGB *leds, int num_leds, const CRGB &color) {
+  for (int i = 0; i < num_leds; i++) leds[i] = color;
+}
+
+// Sample the gradient at 16 evenly spaced indices
+CRGBPalette16::CRGBPalette16(TProgmemRGBGradientPalettePtr gradient) {
+  for (uint8_t i = 0; i < 16; i++) {
+    uint8_t index = i * 17;
+    const uint8_t *lo = gradient;
+    const uint8_t *hi = gradient;
+    while (hi[0] < index) {
+      lo = hi;
+      hi += 4;
+    }
+    uint8_t span = hi[0] - lo[0];
+    uint8_t f = span ? ((index - lo[0]) * 255) / span : 0;
+    for (uint8_t c = 0; c < 3; c++) {
+      entries[i][c] = scale8(lo[c + 1], 255 - f) + scale8(hi[c + 1], f);
+    }
+  }
+}
+
+// Linear blend between neighbouring entries, like FastLED's LINEARBLEND
+CRGB ColorFromPalette(const CRGBPalette16 &pal, uint8_t index,
+                      uint8_t brightness) {
+  uint8_t hi4 = index >> 4;
+  uint8_t lo4 = index & 0x0F;
+  CRGB c = pal[hi4];
+  if (lo4) {
+    const CRGB &n = pal[(hi4 + 1) & 0x0F];
+    uint8_t f2 = lo4 << 4;
+    uint8_t f1 = 255 - f2;
+    for (uint8_t i = 0; i < 3; i++) c[i] = scale8(c[i], f1) + scale8(n[i], f2);
+  }
+  if (brightness != 255) c.nscale8(brightness);
+  return c;
+}
+
+void CLEDController::showLeds(uint8_t brightness) {
+  if (FastLED.sink) FastLED.sink(leds, size, brightness);
+}
+
+void CFastLED::show() {
+  for (int i = 0; i < count; i++) controllers[i].showLeds(brightness);
+}
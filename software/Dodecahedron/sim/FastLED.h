@@ -0,0 +1,144 @@
+#ifndef SIM_FASTLED_H
+#define SIM_FASTLED_H
+/*------------------------------------------------------------------------------
+ * FastLED stand-in for the native simulator
+ *------------------------------------------------------------------------------
+ * Implements the subset of FastLED the animations use. Colour math follows the
+ * FastLED formulas closely enough to compare timings and frames between runs,
+ * but hsv to rgb uses a plain spectrum conversion, so frames will not match
+ * the device bit for bit.
+ *
+ * Instead of clocking out data, show() hands the frame of every controller to
+ * an optional sink so the simulator can dump it to a file.
+ *----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+
+typedef uint8_t fract8;
+
+static inline uint8_t scale8(uint8_t i, fract8 scale) {
+  return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8;
+}
+static inline uint8_t qadd8(uint8_t i, uint8_t j) {
+  uint16_t t = i + j;
+  return t > 255 ? 255 : t;
+}
+static inline void nscale8x3(uint8_t &r, uint8_t &g, uint8_t &b,
+                             fract8 scale) {
+  r = scale8(r, scale);
+  g = scale8(g, scale);
+  b = scale8(b, scale);
+}
+
+struct CHSV {
+  union {
+    struct {
+      uint8_t h, s, v;
+    };
+    struct {
+      uint8_t hue, sat, val;
+    };
+    uint8_t raw[3];
+  };
+  CHSV() : h(0), s(0), v(0) {}
+  CHSV(uint8_t ih, uint8_t is, uint8_t iv) : h(ih), s(is), v(iv) {}
+};
+
+struct CRGB {
+  union {
+    struct {
+      uint8_t r, g, b;
+    };
+    struct {
+      uint8_t red, green, blue;
+    };
+    uint8_t raw[3];
+  };
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(uint32_t colorcode)
+      : r((colorcode >> 16) & 0xFF),
+        g((colorcode >> 8) & 0xFF),
+        b(colorcode & 0xFF) {}
+  CRGB(const CHSV &hsv);
+  CRGB &operator=(const CHSV &hsv) { return *this = CRGB(hsv); }
+  uint8_t &operator[](uint8_t x) { return raw[x]; }
+  const uint8_t &operator[](uint8_t x) const { return raw[x]; }
+  CRGB &nscale8(uint8_t scale) {
+    nscale8x3(r, g, b, scale);
+    return *this;
+  }
+  CRGB &fadeToBlackBy(uint8_t fade) { return nscale8(255 - fade); }
+  explicit operator bool() const { return r | g | b; }
+  bool operator==(const CRGB &c) const {
+    return r == c.r && g == c.g && b == c.b;
+  }
+  bool operator!=(const CRGB &c) const { return !(*this == c); }
+};
+
+void fadeToBlackBy(CRGB *leds, uint16_t num_leds, uint8_t fade);
+void fill_solid(CRGB *leds, int num_leds, const CRGB &color);
+
+// Gradient palettes are a list of (index, r, g, b) entries ending at 255
+typedef const uint8_t TProgmemRGBGradientPalette_byte;
+typedef const TProgmemRGBGradientPalette_byte *TProgmemRGBGradientPalettePtr;
+#define DEFINE_GRADIENT_PALETTE(X) \
+  extern const TProgmemRGBGradientPalette_byte X[] =
+
+class CRGBPalette16 {
+ public:
+  CRGB entries[16];
+  CRGBPalette16() {}
+  CRGBPalette16(TProgmemRGBGradientPalettePtr gradient);
+  CRGB &operator[](uint8_t x) { return entries[x]; }
+  const CRGB &operator[](uint8_t x) const { return entries[x]; }
+};
+
+CRGB ColorFromPalette(const CRGBPalette16 &pal, uint8_t index,
+                      uint8_t brightness = 255);
+
+enum EOrder { RGB = 0012, GRB = 0102 };
+#define DISABLE_DITHER 0x00
+#define BINARY_DITHER 0x01
+
+class CLEDController {
+ public:
+  CRGB *leds = nullptr;
+  int size = 0;
+  void showLeds(uint8_t brightness);
+};
+
+template <uint8_t DATA_PIN, EOrder RGB_ORDER>
+class WS2813 {};
+
+class CFastLED {
+ public:
+  static const uint8_t CONTROLLERS = 32;
+  // Called with every controller's pixels on show(), simulator only
+  typedef void (*Sink)(const CRGB *leds, int size, uint8_t brightness);
+  Sink sink = nullptr;
+
+ private:
+  CLEDController controllers[CONTROLLERS];
+  int count = 0;
+  uint8_t brightness = 255;
+  uint8_t dither = BINARY_DITHER;
+
+ public:
+  template <template <uint8_t, EOrder> class CHIPSET, uint8_t DATA_PIN,
+            EOrder RGB_ORDER>
+  CLEDController &addLeds(CRGB *data, int offset, int size) {
+    CLEDController &c = controllers[count++];
+    c.leds = data + offset;
+    c.size = size;
+    return c;
+  }
+  void setBrightness(uint8_t scale) { brightness = scale; }
+  uint8_t getBrightness() const { return brightness; }
+  void setDither(uint8_t mode) { dither = mode; }
+  void show();
+  int size() const { return count; }
+  CLEDController &operator[](int x) { return controllers[x]; }
+};
+extern CFastLED FastLED;
+#endif
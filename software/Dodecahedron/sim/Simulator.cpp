@@ -0,0 +1,181 @@
+/*------------------------------------------------------------------------------
+ * Native simulator
+ *------------------------------------------------------------------------------
+ * Runs the animations on the host without the installation attached, so the
+ * effects can be profiled and their output inspected. The frame time
+ * histograms of all profiler probes are printed at the end, with the host
+ * clock scaled to ESP32 cycles.
+ *
+ * pio run -e native && .pio/build/native/program [options]
+ *   -n frames   amount of frames to render (default 1000, 600 per scene
+ *               with -b)
+ *   -f fps      virtual clock rate, 0 uses the host clock unthrottled
+ *               (default 60)
+ *   -s scene    start the given mqtt scene instead of the sequence, -p and -v
+ *               take the scene from the recording
+ *   -c file     load scenes from a JSON file instead of the built in ones
+ *   -r seed     seed for random() (default 1)
+ *   -o file     write every transmitted frame as raw RGB bytes to file
+ *   -w file     record the composited frames, see core/Recorder.h
+ *   -p file     play a recording through the output stage only
+ *   -v file     render with the seed, scene and frame times of a recording
+ *               and compare every frame, exits with 2 on the first
+ *               difference. Pass the same -c as the recording.
+ *   -b          run the benchmark suite, see Benchmark.h
+ *----------------------------------------------------------------------------*/
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#include "Benchmark.h"
+#include "core/Recorder.h"
+#include "main.h"
+#include "power/Arena.h"
+#include "power/Profiler.h"
+#include "space/Animation.h"
+#include "space/Scenes.h"
+/*------------------------------------------------------------------------------
+ * Globals
+ *----------------------------------------------------------------------------*/
+// Global configuration parameters
+Config config;
+// Frame dump file
+static FILE *output = nullptr;
+
+// Brightness is left out, the dump holds the levels before scaling
+static void dump(const CRGB *leds, int size, uint8_t) {
+  fwrite(leds, sizeof(CRGB), size, output);
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t frames = 0;
+  float fps = 60;
+  unsigned long seed = 1;
+  const char *record = nullptr;
+  enum { RENDER, PLAY, VERIFY, BENCHMARK } mode = RENDER;
+  FILE *recording = nullptr;
+  Scenes::defaults();
+  int opt;
+  while ((opt = getopt(argc, argv, "n:f:s:c:r:o:w:p:v:b")) != -1) {
+    switch (opt) {
+      case 'n':
+        frames = strtoul(optarg, nullptr, 0);
+        break;
+      case 'f':
+        fps = strtof(optarg, nullptr);
+        break;
+      case 's':
+        config.network.mqtt_values.scene = atoi(optarg);
+        break;
+      case 'c': {
+        std::ifstream file(optarg);
+        std::stringstream json;
+        json << file.rdbuf();
+        if (!file || !Scenes::load(json.str().c_str())) {
+          fprintf(stderr, "%s: using built in scenes\n", optarg);
+        }
+        break;
+      }
+      case 'r':
+        seed = strtoul(optarg, nullptr, 0);
+        break;
+      case 'o':
+        if ((output = fopen(optarg, "wb")) == nullptr) {
+          perror(optarg);
+          return 1;
+        }
+        FastLED.sink = dump;
+        break;
+      case 'w':
+        record = optarg;
+        break;
+      case 'p':
+      case 'v':
+        if ((recording = fopen(optarg, "rb")) == nullptr) {
+          perror(optarg);
+          return 1;
+        }
+        mode = opt == 'p' ? PLAY : VERIFY;
+        break;
+      case 'b':
+        mode = BENCHMARK;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n frames] [-f fps] [-s scene] "
+                        "[-c scenes] [-r seed] [-o file] [-w file] "
+                        "[-p file] [-v file] [-b]\n", argv[0]);
+        return 1;
+    }
+  }
+  if (mode == BENCHMARK) return sim::benchmark(frames ? frames : 600, seed);
+  if (frames == 0) frames = 1000;
+  if (record && mode != RENDER) {
+    fprintf(stderr, "-w can not be combined with -p or -v\n");
+    return 1;
+  }
+  sim::virtual_clock(fps > 0 || mode != RENDER);
+  if (mode != RENDER) {
+    uint32_t recorded;
+    int16_t scene;
+    if (!Recorder::play(recording, recorded, scene)) {
+      fprintf(stderr, "not a recording of %u leds\n", Display::PIXELS);
+      return 1;
+    }
+    seed = recorded;
+    config.network.mqtt_values.scene = scene;
+  }
+  randomSeed(seed);
+  if (mode == PLAY) {
+    Display::begin();
+  } else {
+    Animation::begin();
+  }
+  if (record && !Recorder::record(fopen(record, "wb"), seed,
+                                  config.network.mqtt_values.scene)) {
+    perror(record);
+    return 1;
+  }
+
+  static CRGB expected[Display::PIXELS];
+  auto start = std::chrono::steady_clock::now();
+  uint32_t frame = 0;
+  for (; frame < frames; frame++) {
+    uint32_t dt = fps > 0 ? 1000000 / fps : 0;
+    if (mode == PLAY) {
+      if (!Recorder::next(Display::leds, dt)) break;
+      sim::advance(dt);
+      Display::update();
+      continue;
+    }
+    if (mode == VERIFY && !Recorder::next(expected, dt)) break;
+    sim::advance(dt);
+    Animation::animate();
+    Profiler::drain();
+    if (mode == VERIFY &&
+        memcmp(expected, Display::leds, sizeof(expected)) != 0) {
+      printf("frame %u differs from the recording\n", frame);
+      return 2;
+    }
+  }
+  frames = frame;
+  Display::flush();
+  auto stop = std::chrono::steady_clock::now();
+
+  double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+  printf("frames=%u ns/frame=%.0f fps=%.1f\n", frames, ns / frames,
+         frames * 1e9 / ns);
+  char profile[1024];
+  if (Profiler::report(profile, sizeof(profile))) printf("%s", profile);
+  printf("arena used=%u peak=%u size=%u\n", (unsigned)Arena::used(),
+         (unsigned)Arena::peak(), (unsigned)Arena::SIZE);
+  if (output) fclose(output);
+  if (record && !Recorder::active()) {
+    fprintf(stderr, "%s: %s\n", record, Recorder::error());
+    return 1;
+  }
+  // the recorder and player share one stream
+  Recorder::stop();
+  return 0;
+}
@@ -0,0 +1,53 @@
+#include "freertos.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+/*------------------------------------------------------------------------------
+ * FreeRTOS stand-in for the native simulator
+ *----------------------------------------------------------------------------*/
+struct sim_task {
+  std::thread thread;
+};
+struct sim_semaphore {
+  std::mutex mutex;
+  std::condition_variable available;
+  uint32_t count = 0;
+};
+
+// Name, stack size, priority and core do not apply to host threads
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *,
+                                   uint32_t, void *parameter, UBaseType_t,
+                                   TaskHandle_t *handle, BaseType_t) {
+  sim_task *t = new sim_task;
+  t->thread = std::thread(task, parameter);
+  t->thread.detach();
+  if (handle) *handle = t;
+  return pdPASS;
+}
+void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+BaseType_t xPortGetCoreID() { return 1; }
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return new sim_semaphore; }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(s->mutex);
+  auto ready = [s] { return s->count > 0; };
+  if (ticks == portMAX_DELAY)
+    s->available.wait(lock, ready);
+  else if (!s->available.wait_for(lock, std::chrono::milliseconds(ticks),
+                                  ready))
+    return pdFALSE;
+  s->count--;
+  return pdTRUE;
+}
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+  std::lock_guard<std::mutex> lock(s->mutex);
+  // binary semaphore, giving twice does not count twice
+  if (s->count) return pdFALSE;
+  s->count = 1;
+  s->available.notify_one();
+  return pdTRUE;
+}
@@ -0,0 +1,35 @@
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+/*------------------------------------------------------------------------------
+ * FreeRTOS stand-in for the native simulator
+ *------------------------------------------------------------------------------
+ * Tasks run as host threads and semaphores are binary semaphores built on a
+ * condition variable, giving one that is already given has no effect. Core
+ * pinning and priorities are accepted but ignored.
+ *----------------------------------------------------------------------------*/
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void *);
+typedef struct sim_task *TaskHandle_t;
+typedef struct sim_semaphore *SemaphoreHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define portTICK_PERIOD_MS 1
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name,
+                                   uint32_t stack, void *parameter,
+                                   UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xPortGetCoreID();
+
+SemaphoreHandle_t xSemaphoreCreateBinary();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+#endif
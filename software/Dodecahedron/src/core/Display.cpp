@@ -1,98 +1,83 @@
-#include "display.h"
+#include "Display.h"
 
+#include <type_traits>
+
+#include "Grid.h"
 #include "main.h"
-/******************************************************************************
- *          How to order and travel around a rhombic dodecahedron             *
- * ****************************************************************************
- *                            A     A     A     A
- *                            |     |     |     |
- *                            B     C     D     B
- *                           /|\   /|\   /|\   /|
- *                         G/ | \E/ | \F/ | \G/ |
- *                         | /H\ | /I\ | /J\ | /H
- *                         |/   \|/   \|/   \|/
- *                         M     K     L     M
- *                         |     |     |     |
- *                         N     N     N     N
- *****************************************************************************/
-Display::Edge Display::Edges[DODECAHEDRA][EDGES] = {    // GPIO
-    {{{A, B}, {0, 42}},    {{B, H}, {42, 84}},          // DIN1
-     {{H, K}, {85, 127}},  {{K, I}, {127, 169}},        //
-     {{E, K}, {170, 212}}, {{K, N}, {212, 254}},        //
-     {{N, L}, {255, 297}}, {{L, F}, {297, 339}},        //
-     {{A, C}, {340, 382}}, {{C, I}, {382, 424}},        // DIN2
-     {{I, L}, {425, 467}}, {{L, J}, {467, 509}},        //
-     {{N, M}, {510, 552}}, {{M, G}, {552, 594}},        //
-     {{G, D}, {595, 637}}, {{D, F}, {637, 679}},        //
-     {{A, D}, {680, 722}}, {{D, J}, {722, 764}},        // DIN3
-     {{J, M}, {765, 807}}, {{M, H}, {807, 849}},        //
-     {{G, B}, {850, 892}}, {{B, E}, {892, 934}},        //
-     {{E, C}, {935, 977}}, {{C, F}, {977, 1019}}},      //
-    {{{A, B}, {1020, 1062}}, {{B, H}, {1062, 1104}},    // DIN4
-     {{H, K}, {1105, 1147}}, {{K, I}, {1147, 1189}},    //
-     {{E, K}, {1190, 1232}}, {{K, N}, {1232, 1274}},    //
-     {{N, L}, {1275, 1317}}, {{L, F}, {1317, 1359}},    //
-     {{A, C}, {1360, 1402}}, {{C, I}, {1402, 1444}},    // DIN5
-     {{I, L}, {1445, 1487}}, {{L, J}, {1487, 1529}},    //
-     {{N, M}, {1530, 1572}}, {{M, G}, {1572, 1614}},    //
-     {{G, D}, {1615, 1657}}, {{D, F}, {1657, 1699}},    //
-     {{A, D}, {1700, 1742}}, {{D, J}, {1742, 1784}},    // DIN6
-     {{J, M}, {1785, 1827}}, {{M, H}, {1827, 1869}},    //
-     {{G, B}, {1870, 1912}}, {{B, E}, {1912, 1954}},    //
-     {{E, C}, {1955, 1997}}, {{C, F}, {1997, 2039}}}};  //
-
-Display::Path Display::Paths[VERTICES] =  // Node
-    {{3, {B, C, D}},                      // A
-     {4, {A, G, H, E}},                   // B
-     {4, {A, E, I, F}},                   // C
-     {4, {A, F, J, G}},                   // D
-     {3, {B, K, C}},                      // E
-     {3, {C, L, D}},                      // F
-     {3, {D, M, B}},                      // G
-     {3, {M, B, K}},                      // H
-     {3, {K, C, L}},                      // I
-     {3, {L, D, M}},                      // J
-     {4, {H, E, I, N}},                   // K
-     {4, {I, F, J, N}},                   // L
-     {4, {J, G, H, N}},                   // M
-     {3, {K, L, M}}};                     // N
-
-// Cartesian coordinates with node A on top and lid to the front
-Vector3 Display::Nodes[VERTICES] = {
-    Vector3(0, sqrt(3) / 2, 0),                         // A
-    Vector3(0, sqrt(3) / 3, sqrt(6) / 3),               // B
-    Vector3(-sqrt(2) / 2, sqrt(3) / 3, -sqrt(6) / 6),   // C
-    Vector3(sqrt(2) / 2, sqrt(3) / 3, -sqrt(6) / 6),    // D
-    Vector3(-sqrt(2) / 2, sqrt(3) / 6, sqrt(6) / 6),    // E
-    Vector3(0, sqrt(3) / 6, -sqrt(6) / 3),              // F
-    Vector3(sqrt(2) / 2, sqrt(3) / 6, sqrt(6) / 6),     // G
-    Vector3(0, -sqrt(3) / 6, sqrt(6) / 3),              // H
-    Vector3(-sqrt(2) / 2, -sqrt(3) / 6, -sqrt(6) / 6),  // I
-    Vector3(sqrt(2) / 2, -sqrt(3) / 6, -sqrt(6) / 6),   // J
-    Vector3(-sqrt(2) / 2, -sqrt(3) / 3, sqrt(6) / 6),   // K
-    Vector3(0, -sqrt(3) / 3, -sqrt(6) / 3),             // L
-    Vector3(sqrt(2) / 2, -sqrt(3) / 3, sqrt(6) / 6),    // M
-    Vector3(0, -sqrt(3) / 2, 0),                        // N
-};
+#include "power/Arena.h"
+
+// Generated tables
+constexpr decltype(Display::Edges) Display::Edges;
+constexpr decltype(Display::Paths) Display::Paths;
+constexpr decltype(Display::Nodes) Display::Nodes;
+constexpr decltype(Display::Links) Display::Links;
+
+// Data pins of the strips, in the order the solids are wired
+static constexpr uint8_t PINS[] = {32, 12, 27, 17, 16, 26};
+static_assert(Display::STRIPS <= sizeof(PINS), "Add a data pin per strip");
+
+// Add a FastLED controller for each strip, starting at strip S
+template <uint8_t S>
+static typename std::enable_if<S == Display::STRIPS>::type attach(CRGB *) {}
+template <uint8_t S>
+static typename std::enable_if<S < Display::STRIPS>::type attach(CRGB *leds) {
+  FastLED.addLeds<WS2813, PINS[S], GRB>(leds, S * Display::STRIP,
+                                        Display::STRIP);
+  attach<S + 1>(leds);
+}
 
 // Static memory for all pixels
 CRGB Display::leds[PIXELS];
 // Coordinates to hues mapping
-Vector3 Display::coordinates[PIXELS];
+Coordinates<Display::PIXELS> Display::coordinates;
+// Front buffer and handoff between rendering and transmitting
+CRGB Display::frame[PIXELS];
+SemaphoreHandle_t Display::frame_ready;
+SemaphoreHandle_t Display::frame_done;
+// Dirty strip tracking
+boolean Display::dirty = false;
+uint32_t Display::input_hash = 0;
+boolean Display::input_still = false;
+uint16_t Display::skip_count = 0;
+uint16_t Display::skip_rate = 0;
+Timer Display::skip_timer = 1.0f;
+// Output stage
+uint16_t Display::correction[3][256];
+// advanced before use, the first frame has phase 0
+uint8_t Display::dither_frame = 255;
+uint32_t Display::output_time = 0;
+uint32_t Display::power_estimate = 0;
 
 void Display::begin() {
-  calibrate(0, config.calibration.angle_solid_0);
-  calibrate(1, config.calibration.angle_solid_1);
-
-  FastLED.addLeds<WS2813, DIN1, GRB>(leds, 0 * STRIP, STRIP);
-  FastLED.addLeds<WS2813, DIN2, GRB>(leds, 1 * STRIP, STRIP);
-  FastLED.addLeds<WS2813, DIN3, GRB>(leds, 2 * STRIP, STRIP);
-  FastLED.addLeds<WS2813, DIN4, GRB>(leds, 3 * STRIP, STRIP);
-  FastLED.addLeds<WS2813, DIN5, GRB>(leds, 4 * STRIP, STRIP);
-  FastLED.addLeds<WS2813, DIN6, GRB>(leds, 5 * STRIP, STRIP);
+  for (uint8_t solid = 0; solid < DODECAHEDRA; solid++) {
+    calibrate(solid, config.calibration.angle_solid[solid]);
+  }
+  Grid::build();
+  correct();
+
+  attach<0>(frame);
   FastLED.setBrightness(255);
   FastLED.setDither(DISABLE_DITHER);
+
+  frame_ready = xSemaphoreCreateBinary();
+  frame_done = xSemaphoreCreateBinary();
+  xSemaphoreGive(frame_done);
+  // Same core as the render loop but higher priority, so transmission starts
+  // immediately and rendering resumes while the I2S DMA clocks out the frame
+  xTaskCreatePinnedToCore(transmit, "Display", 4096, NULL, 2, NULL, 1);
 }
+// Hand the rendered frame to the transmit task, leds keeps its content so
+// animations can keep drawing on top of the previous frame.
+//
+// The output stage converts the linear leds to the frame in one pass, looking
+// up gamma and white balance per channel and adding a temporal dither offset
+// before dropping the fraction. I2S sends all strips at once, so only a frame
+// where no byte changed is skipped. While the input stays the same the dither
+// phase is held, so still images are skipped too.
+//
+// The same pass sums the output levels per channel to estimate the current
+// draw. When it exceeds the budget the global brightness is lowered, which
+// FastLED applies while transmitting, so limiting costs no extra pass.
 void Display::update() {
   // for (int i = 0; i < STRIP; i++) {
   //   leds[0 * STRIP + i] = CRGB(255, 0, 0);
@@ -102,77 +87,199 @@ void Display::update() {
   //   leds[4 * STRIP + i] = CRGB(0, 255, 0);
   //   leds[5 * STRIP + i] = CRGB(0, 0, 255);
   // }
-  FastLED.show();
+  xSemaphoreTake(frame_done, portMAX_DELAY);
+  uint32_t start = micros();
+  // Bit reversed frame counter spreads the offsets evenly over time, and an
+  // odd step per pixel keeps neighbours out of phase. Without dithering the
+  // offset is half a level, so the fraction is rounded.
+  uint8_t offset = 128, step = 0;
+  if (config.display.dither) {
+    // A still image keeps its dither phase so its frames come out identical
+    // and are not transmitted again
+    if (!input_still) dither_frame++;
+    uint8_t f = dither_frame;
+    f = (f & 0xF0) >> 4 | (f & 0x0F) << 4;
+    f = (f & 0xCC) >> 2 | (f & 0x33) << 2;
+    offset = (f & 0xAA) >> 1 | (f & 0x55) << 1;
+    step = 71;
+  }
+  uint32_t sum[3] = {0, 0, 0};
+  uint32_t hash = 0;
+  uint8_t changed = 0;
+  for (uint16_t i = 0; i < PIXELS; i++) {
+    const CRGB s = leds[i];
+    hash = (hash << 5 | hash >> 27) ^ (s.r | s.g << 8 | s.b << 16);
+    CRGB c;
+    c.r = (correction[0][s.r] + offset) >> 8;
+    c.g = (correction[1][s.g] + offset) >> 8;
+    c.b = (correction[2][s.b] + offset) >> 8;
+    changed |= (c.r ^ frame[i].r) | (c.g ^ frame[i].g) | (c.b ^ frame[i].b);
+    frame[i] = c;
+    sum[0] += c.r;
+    sum[1] += c.g;
+    sum[2] += c.b;
+    offset += step;
+  }
+  // The dither phase of the next frame follows this comparison, so the
+  // second frame of a still image is the first one skipped
+  input_still = hash == input_hash;
+  input_hash = hash;
+  dirty = changed;
+  // Current of each channel at full level plus the idle current per led
+  const auto &p = config.display.power;
+  uint32_t idle = PIXELS * p.idle_ma;
+  uint32_t active = (sum[0] * p.red_ma + sum[1] * p.green_ma +
+                     sum[2] * p.blue_ma) / 255;
+  power_estimate = idle + active;
+  uint8_t brightness = 255;
+  if (power_estimate > p.budget_ma) {
+    // When the idle current alone exceeds the budget, dark is the closest
+    brightness = p.budget_ma > idle ? (255 * (p.budget_ma - idle)) / active : 0;
+  }
+  // A new brightness changes every pixel, even the unchanged ones
+  if (brightness != FastLED.getBrightness()) {
+    FastLED.setBrightness(brightness);
+    dirty = true;
+  }
+  if (!dirty) skip_count++;
+  output_time = micros() - start;
+  if (skip_timer.update()) {
+    skip_rate = skip_count;
+    skip_count = 0;
+  }
+  xSemaphoreGive(frame_ready);
+}
+
+void Display::flush() {
+  xSemaphoreTake(frame_done, portMAX_DELAY);
+  xSemaphoreGive(frame_done);
+}
+
+void Display::transmit(void *) {
+  while (true) {
+    xSemaphoreTake(frame_ready, portMAX_DELAY);
+    // I2S clocks out all strips in parallel, so a frame is sent whole or not
+    if (dirty) FastLED.show();
+    xSemaphoreGive(frame_done);
+  }
+}
+uint16_t Display::skipped() { return skip_rate; }
+uint32_t Display::output() { return output_time; }
+uint32_t Display::power() { return power_estimate; }
+
+// Level 255 maps to white << 8 so adding a dither offset never overflows
+void Display::correct() {
+  const CRGB &white = config.display.white;
+  for (uint8_t c = 0; c < 3; c++) {
+    for (uint16_t v = 0; v < 256; v++) {
+      correction[c][v] = powf(v / 255.0f, config.display.gamma) * white[c] *
+                         256;
+    }
+  }
 }
 void Display::fade(uint8_t i) { fadeToBlackBy(leds, PIXELS, i); }
 
 // Calibrate led coordinates of specified solid
 void Display::calibrate(uint8_t solid, float angle) {
-  Vector3 axis = Vector3(0, 1, 0);
-  Vector3 translation = Vector3(1, 1, 1);
-  Vector3 scale = Vector3(0.5, 0.5, 0.5);
-  for (uint8_t edge = 0; edge < Display::EDGES; edge++) {
-    uint16_t l0 = Edges[solid][edge].led[0];
-    uint16_t l1 = Edges[solid][edge].led[1];
-    Vector3 v0 = axis.rotate(angle, Nodes[Edges[solid][edge].node[0]]) +
-                 translation * scale;
-    Vector3 v1 = axis.rotate(angle, Nodes[Edges[solid][edge].node[1]]) +
-                 translation * scale;
-    Vector3 delta = (v1 - v0) / (l1 - l0);
+  rotate(solid, Quaternion(Vector3(0, 1, 0), angle));
+}
+
+// Rotate all solids by q on top of their calibration angle
+void Display::rotate(const Quaternion &q) {
+  for (uint8_t solid = 0; solid < DODECAHEDRA; solid++) {
+    float angle = config.calibration.angle_solid[solid];
+    rotate(solid, q * Quaternion(Vector3(0, 1, 0), angle));
+  }
+}
+
+// Only the nodes are rotated, using a matrix built once from q. The leds are
+// interpolated along each edge in fixed point with 8 extra fractional bits.
+void Display::rotate(uint8_t solid, const Quaternion &q) {
+  const int32_t ONE = Coordinates<PIXELS>::ONE << 8;
+  Matrix3 m = Matrix3(q);
+  Vector3 center = Vector3(0.5, 0.5, 0.5);
+  int32_t node[VERTICES][3];
+  for (uint8_t n = 0; n < VERTICES; n++) {
+    Vector3 v = m * Vector3(Nodes[n].x, Nodes[n].y, Nodes[n].z) + center;
+    node[n][0] = v.x * ONE;
+    node[n][1] = v.y * ONE;
+    node[n][2] = v.z * ONE;
+  }
+  for (uint8_t edge = 0; edge < EDGES; edge++) {
+    const Edge &e = Edges[solid][edge];
+    const int32_t *v0 = node[e.node[0]];
+    const int32_t *v1 = node[e.node[1]];
+    int32_t steps = e.led[1] - e.led[0];
+    int32_t dx = (v1[0] - v0[0]) / steps;
+    int32_t dy = (v1[1] - v0[1]) / steps;
+    int32_t dz = (v1[2] - v0[2]) / steps;
+    int32_t x = v0[0], y = v0[1], z = v0[2];
     // include last led since both first and last led are on the edge
-    for (uint16_t lx = l0; lx <= l1; lx++) {
-      coordinates[lx] = v0;
-      v0 += delta;
+    for (uint16_t lx = e.led[0]; lx <= e.led[1]; lx++) {
+      coordinates.x[lx] = (x + 128) >> 8;
+      coordinates.y[lx] = (y + 128) >> 8;
+      coordinates.z[lx] = (z + 128) >> 8;
+      x += dx;
+      y += dy;
+      z += dz;
     }
   }
 }
 
-void Display::Wisp::init(uint8_t solid_, uint8_t edge_, uint8_t direction_,
-                         uint8_t position_, CRGB color_) {
-  // Safe initialization of parameters
-  solid = solid_ & 1;
-  edge = edge_ % EDGES;
-  direction = direction_ & 1;
-  position = position_;
-  color = color_;
+Display::WispSwarm::~WispSwarm() { release(); }
+
+// Lease a bigger array and move the first n elements over
+template <class T>
+static bool regrow(T *&array, uint16_t n, uint16_t capacity) {
+  T *grown = Arena::lease<T>(capacity);
+  if (grown == nullptr) return false;
+  if (array != nullptr) memcpy(grown, array, n * sizeof(T));
+  Arena::release(array);
+  array = grown;
+  return true;
 }
 
-uint16_t Display::Wisp::led() {
-  uint16_t led = Edges[solid][edge].led[direction];
-  if (direction == 0) {
-    led += position;
-  } else {
-    led -= position;
+bool Display::WispSwarm::grow(uint16_t capacity_) {
+  if (capacity_ <= capacity) return true;
+  // On failure the arrays that did grow keep working at the old capacity
+  if (!regrow(solids, count, capacity_) || !regrow(edges, count, capacity_) ||
+      !regrow(directions, count, capacity_) ||
+      !regrow(positions, count, capacity_) ||
+      !regrow(colors, count, capacity_) || !regrow(speeds, count, capacity_) ||
+      !regrow(progress, count, capacity_)) {
+    return false;
   }
-  return led;
+  capacity = capacity_;
+  return true;
 }
 
-void Display::Wisp::move() {
-  if (++position > (Edges[solid][edge].led[1] - Edges[solid][edge].led[0])) {
-    // Start position on new node
-    position = 0;
-    // Arrived at new node.
-    uint8_t new_node = Edges[solid][edge].node[1 - direction];
-    // Arrived from old node
-    uint8_t old_node = Edges[solid][edge].node[direction];
-    // Going to random next node but not back to old node
-    uint8_t next_node = old_node;
-    while (next_node == old_node)
-      next_node = Paths[new_node].node[random(0, Paths[new_node].faces)];
-    // find an edge going from new node to next node or visa versa
-    for (int i = 0; i < EDGES; i++) {
-      if ((Edges[solid][i].node[0] == new_node) &&
-          (Edges[solid][i].node[1] == next_node)) {
-        edge = i;
-        direction = 0;
-        break;
-      }
-      if ((Edges[solid][i].node[0] == next_node) &&
-          (Edges[solid][i].node[1] == new_node)) {
-        edge = i;
-        direction = 1;
-        break;
-      }
-    }
-  }
+void Display::WispSwarm::release() {
+  Arena::release(solids);
+  Arena::release(edges);
+  Arena::release(directions);
+  Arena::release(positions);
+  Arena::release(colors);
+  Arena::release(speeds);
+  Arena::release(progress);
+  solids = edges = directions = positions = nullptr;
+  colors = nullptr;
+  speeds = progress = nullptr;
+  capacity = count = 0;
+}
+
+void Display::WispSwarm::clear() { count = 0; }
+
+uint16_t Display::WispSwarm::add(uint8_t solid_, uint8_t edge_,
+                                 uint8_t direction_, uint8_t position_,
+                                 CRGB color_, uint16_t speed_) {
+  if (count >= capacity) return capacity;
+  // Safe initialization of parameters
+  solids[count] = solid_ % DODECAHEDRA;
+  edges[count] = edge_ % EDGES;
+  directions[count] = direction_ & 1;
+  positions[count] = position_;
+  colors[count] = color_;
+  speeds[count] = speed_;
+  progress[count] = 0;
+  return count++;
 }
@@ -4,87 +4,183 @@
 #include <Arduino.h>
 #include <FastLED.h>
 
+#include "core/Topology.h"
+#include "power/Coordinates.h"
 #include "power/Math3D.h"
+#include "power/Timer.h"
+
+// Amount of solids and leds per strip, can be overridden with build flags.
+// More than 2 solids needs a data pin per extra strip in Display.cpp.
+#ifndef DISPLAY_DODECAHEDRA
+#define DISPLAY_DODECAHEDRA 2
+#endif
+#ifndef DISPLAY_STRIP
+#define DISPLAY_STRIP 340
+#endif
 
 class Display {
  public:
-  static const uint8_t DODECAHEDRA = 2;
-  static const uint8_t EDGES = 24;
-  static const uint8_t VERTICES = 14;
-  static const uint16_t STRIP = 340;
-  static const uint16_t PIXELS = 6 * STRIP;
+  typedef topology::Topology<DISPLAY_DODECAHEDRA, DISPLAY_STRIP> Layout;
+  static const uint8_t DODECAHEDRA = DISPLAY_DODECAHEDRA;
+  static const uint8_t EDGES = Layout::EDGES;
+  static const uint8_t VERTICES = Layout::VERTICES;
+  static const uint16_t STRIP = DISPLAY_STRIP;
+  static const uint8_t STRIPS = Layout::STRIPS;
+  static const uint16_t PIXELS = Layout::PIXELS;
   static CRGB leds[PIXELS];
-  static Vector3 coordinates[PIXELS];
+  static Coordinates<PIXELS> coordinates;
 
  private:
-  static const uint8_t A = 0;
-  static const uint8_t B = 1;
-  static const uint8_t C = 2;
-  static const uint8_t D = 3;
-  static const uint8_t E = 4;
-  static const uint8_t F = 5;
-  static const uint8_t G = 6;
-  static const uint8_t H = 7;
-  static const uint8_t I = 8;
-  static const uint8_t J = 9;
-  static const uint8_t K = 10;
-  static const uint8_t L = 11;
-  static const uint8_t M = 12;
-  static const uint8_t N = 13;
-
-  static const uint8_t DIN1 = 32;
-  static const uint8_t DIN2 = 12;
-  static const uint8_t DIN3 = 27;
-  static const uint8_t DIN4 = 17;
-  static const uint8_t DIN5 = 16;
-  static const uint8_t DIN6 = 26;
-
-  // An edge had 2 nodes mapping to 2 leds
-  struct Edge {
-    uint8_t node[2];
-    uint16_t led[2];
-  };
-  // A node is connected to 3 or 4 other nodes
-  struct Path {
-    uint8_t faces;
-    uint8_t node[4];
-  };
+  typedef topology::Edge Edge;
+  typedef topology::Path Path;
+  typedef topology::Link Link;
 
   // Led edge mapping on each dodecahedra
-  static Edge Edges[DODECAHEDRA][EDGES];
+  static constexpr topology::Table<topology::Table<Edge, EDGES>, DODECAHEDRA>
+      Edges = Layout::edges();
   // Paths that can be taken from each node
-  static Path Paths[VERTICES];
+  static constexpr topology::Table<Path, VERTICES> Paths = Layout::paths();
   // Cartesian coordinates of each node
-  static Vector3 Nodes[VERTICES];
+  static constexpr topology::Table<topology::Point, VERTICES> Nodes =
+      Layout::nodes();
+  // Edge and direction going from node to node, edge = EDGES if not adjacent
+  static constexpr topology::Table<topology::Table<Link, VERTICES>, VERTICES>
+      Links = Layout::links();
+
+  // Frame being transmitted while the next frame is rendered in leds
+  static CRGB frame[PIXELS];
+  // Given when frame holds a new frame to transmit
+  static SemaphoreHandle_t frame_ready;
+  // Given when frame has been transmitted and can be overwritten
+  static SemaphoreHandle_t frame_done;
+  // The frame changed since the last transmitted frame
+  static boolean dirty;
+  // Hash of the last input frame and whether it matched the one before
+  static uint32_t input_hash;
+  static boolean input_still;
+  // Frames skipped in the current second and in the last full second
+  static uint16_t skip_count;
+  static uint16_t skip_rate;
+  static Timer skip_timer;
+  // Task transmitting frames to the strips
+  static void transmit(void *);
+
+  // Gamma and white balance per channel, 8.8 fixed point output levels
+  static uint16_t correction[3][256];
+  // Frame counter driving the temporal dither pattern
+  static uint8_t dither_frame;
+  // Time taken by the output stage of the last frame in microseconds
+  static uint32_t output_time;
+  // Estimated current of the last frame in mA, before limiting
+  static uint32_t power_estimate;
 
  public:
   static void begin();
   static void update();
+  // Wait until the last frame has been transmitted
+  static void flush();
   static void fade(uint8_t i);
   static void calibrate(uint8_t solid, float a);
+  // Rotate the led coordinates of all solids or one solid. The grid is not
+  // rebuilt, call Grid::build() when grid queries need the new positions.
+  static void rotate(const Quaternion &q);
+  static void rotate(uint8_t solid, const Quaternion &q);
+  // Amount of unchanged frames not transmitted during the last second
+  static uint16_t skipped();
+  // Rebuild the gamma and white balance tables from the config
+  static void correct();
+  // Microseconds the output stage took for the last frame
+  static uint32_t output();
+  // Estimated current draw of the last frame in mA, before limiting
+  static uint32_t power();
 
  public:
-  // Wisp is a position on an edge on a solid, moving in a direction
-  class Wisp {
+  // WispSwarm holds wisps, positions on an edge of a solid moving in a
+  // direction, as a structure of arrays. The arrays are leased from the Arena
+  // and the swarm can grow while it is in use.
+  class WispSwarm {
    private:
+    // maximum and current amount of wisps
+    uint16_t capacity = 0;
+    uint16_t count = 0;
     // Edge = Edges[solid][edge]
-    uint8_t solid = 0;
-    uint8_t edge = 0;
+    uint8_t *solids = nullptr;
+    uint8_t *edges = nullptr;
     // direction 0 = node[0] -> node[1]
     // direction 1 = node[1] -> node[0]
-    uint8_t direction = 0;
+    uint8_t *directions = nullptr;
     // Relative position on the edge with respect to direction
-    uint8_t position = 0;
+    uint8_t *positions = nullptr;
+    CRGB *colors = nullptr;
+    // leds per second and the fraction of a led travelled, 0.16 fixed point
+    uint16_t *speeds = nullptr;
+    uint16_t *progress = nullptr;
+    // xorshift state for choosing paths, cheaper than random()
+    uint32_t seed = 0x9E3779B9;
 
-   public:
-    // current color, can be changed
-    CRGB color = CRGB(0, 0, 0);
+    // Move wisp i one led, s is the path choice state
+    void step(uint16_t i, uint32_t &s) {
+      const Edge &e = Edges[solids[i]][edges[i]];
+      if (++positions[i] <= e.led[1] - e.led[0]) return;
+      // Arrived at a node, start on a new edge
+      positions[i] = 0;
+      uint8_t new_node = e.node[1 - directions[i]];
+      uint8_t old_node = e.node[directions[i]];
+      // Going to random next node but not back to old node, the old node is
+      // swapped for the last path so the choice stays uniform without retries
+      s ^= s << 13;
+      s ^= s >> 17;
+      s ^= s << 5;
+      const Path &path = Paths[new_node];
+      uint8_t next_node = path.node[s % (path.faces - 1)];
+      if (next_node == old_node) next_node = path.node[path.faces - 1];
+      // Edge going from new node to next node or visa versa
+      edges[i] = Links[new_node][next_node].edge;
+      directions[i] = Links[new_node][next_node].direction;
+    }
 
    public:
-    void init(uint8_t solid_, uint8_t edge_, uint8_t direction_,
-              uint8_t position_, CRGB color_);
-    void move();
-    uint16_t led();
+    WispSwarm() = default;
+    ~WispSwarm();
+    WispSwarm(const WispSwarm &) = delete;
+    WispSwarm &operator=(const WispSwarm &) = delete;
+    // Make room for capacity wisps keeping the current ones, returns false
+    // when the Arena is out of memory
+    bool grow(uint16_t capacity_);
+    // Return the arrays to the Arena, the swarm is empty afterwards
+    void release();
+    // Remove all wisps from the swarm
+    void clear();
+    // Add a wisp, returns its index or capacity if the swarm is full
+    uint16_t add(uint8_t solid_, uint8_t edge_, uint8_t direction_,
+                 uint8_t position_, CRGB color_, uint16_t speed_ = 0);
+    // Move all wisps as far as their speed takes them in dt seconds, in one
+    // loop over the arrays. f(i, from, to) is called for every led a wisp
+    // steps, so a late frame still visits every led passed.
+    template <class F>
+    void move(float dt, F f) {
+      // dt in 16.16 fixed point, below a second so speed * t fits 32 bit
+      uint32_t t = dt < 1.0f ? (uint32_t)(dt * 65536) : 0xFFFF;
+      uint32_t s = seed;
+      for (uint16_t i = 0; i < count; i++) {
+        uint32_t travelled = progress[i] + speeds[i] * t;
+        progress[i] = travelled;
+        for (uint16_t n = travelled >> 16; n > 0; n--) {
+          uint16_t from = led(i);
+          step(i, s);
+          f(i, from, led(i));
+        }
+      }
+      seed = s;
+    }
+    uint16_t size() const { return count; }
+    uint16_t led(uint16_t i) const {
+      const Edge &e = Edges[solids[i]][edges[i]];
+      return directions[i] == 0 ? e.led[0] + positions[i]
+                                : e.led[1] - positions[i];
+    }
+    CRGB &color(uint16_t i) { return colors[i]; }
+    uint16_t &speed(uint16_t i) { return speeds[i]; }
   };
 };
 #endif
\ No newline at end of file
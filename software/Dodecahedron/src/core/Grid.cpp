@@ -0,0 +1,52 @@
+#include "Grid.h"
+/*------------------------------------------------------------------------------
+ * GRID STATIC DEFINITIONS
+ *----------------------------------------------------------------------------*/
+Vector3 Grid::origin;
+Vector3 Grid::size;
+Vector3 Grid::scale;
+uint16_t Grid::start[CELLS * CELLS * CELLS + 1];
+uint16_t Grid::index[Display::PIXELS];
+/*----------------------------------------------------------------------------*/
+uint8_t Grid::cell(float v, float o, float s) {
+  float c = (v - o) * s;
+  if (c < 0) return 0;
+  if (c >= CELLS) return CELLS - 1;
+  return c;
+}
+uint16_t Grid::cell(const Vector3& v) {
+  uint8_t x = cell(v.x, origin.x, scale.x);
+  uint8_t y = cell(v.y, origin.y, scale.y);
+  uint8_t z = cell(v.z, origin.z, scale.z);
+  return (z * CELLS + y) * CELLS + x;
+}
+
+// Counting sort of all leds by the cell they are in
+void Grid::build() {
+  Vector3 lo = Display::coordinates[0];
+  Vector3 hi = lo;
+  for (uint16_t led = 1; led < Display::PIXELS; led++) {
+    Vector3 v = Display::coordinates[led];
+    lo = Vector3(fminf(lo.x, v.x), fminf(lo.y, v.y), fminf(lo.z, v.z));
+    hi = Vector3(fmaxf(hi.x, v.x), fmaxf(hi.y, v.y), fmaxf(hi.z, v.z));
+  }
+  // Grow the box a little so leds on the high side fall inside the grid
+  Vector3 margin = Vector3(1e-3f, 1e-3f, 1e-3f);
+  origin = lo - margin;
+  size = (hi + margin - origin) / CELLS;
+  scale = Vector3(1 / size.x, 1 / size.y, 1 / size.z);
+
+  memset(start, 0, sizeof(start));
+  for (uint16_t led = 0; led < Display::PIXELS; led++) {
+    start[cell(Display::coordinates[led]) + 1]++;
+  }
+  for (uint16_t c = 0; c < CELLS * CELLS * CELLS; c++) {
+    start[c + 1] += start[c];
+  }
+  // Place each led after the ones already placed in its cell
+  uint16_t fill[CELLS * CELLS * CELLS];
+  memcpy(fill, start, sizeof(fill));
+  for (uint16_t led = 0; led < Display::PIXELS; led++) {
+    index[fill[cell(Display::coordinates[led])]++] = led;
+  }
+}
@@ -0,0 +1,122 @@
+#ifndef GRID_H
+#define GRID_H
+#include <math.h>
+#include <stdint.h>
+
+#include "core/Display.h"
+#include "power/Math3D.h"
+/*------------------------------------------------------------------------------
+ * GRID CLASS
+ *------------------------------------------------------------------------------
+ * Uniform grid over the led coordinates. The bounding box of all leds is cut
+ * in CELLS x CELLS x CELLS cells and the leds are sorted by cell, so a query
+ * only visits the cells overlapping the queried shape. Cells completely
+ * inside the shape are reported without testing each led.
+ *
+ * The grid is a snapshot, call build() again after the coordinates change.
+ *
+ * Queries call f(led) for every led inside the shape:
+ * Grid::sphere(center, 0.2f, [](uint16_t led) { Display::leds[led] = ...; });
+ *----------------------------------------------------------------------------*/
+class Grid {
+ public:
+  static const uint8_t CELLS = 8;
+
+ private:
+  // Lower corner of the grid, size of a cell and its reciprocal
+  static Vector3 origin;
+  static Vector3 size;
+  static Vector3 scale;
+  // leds sorted by cell, cell c holds index[start[c]] to index[start[c + 1]]
+  static uint16_t start[CELLS * CELLS * CELLS + 1];
+  static uint16_t index[Display::PIXELS];
+
+  // Cell of v on one axis, clamped to the grid
+  static uint8_t cell(float v, float o, float s);
+  // Cell of a led
+  static uint16_t cell(const Vector3& v);
+  // Call f for each led of a cell, testing them if not fully inside
+  template <class T, class F>
+  static void visit(uint16_t c, bool inside, T test, F f) {
+    for (uint16_t i = start[c]; i < start[c + 1]; i++) {
+      uint16_t led = index[i];
+      if (inside || test(Display::coordinates[led])) f(led);
+    }
+  }
+
+ public:
+  // Sort all led coordinates into the grid
+  static void build();
+
+  // All leds within radius of center (inclusive)
+  template <class F>
+  static void sphere(const Vector3& center, float radius, F f) {
+    Vector3 r(radius, radius, radius);
+    Vector3 l = center - r, h = center + r;
+    float rr = radius * radius;
+    for (uint8_t z = cell(l.z, origin.z, scale.z);
+         z <= cell(h.z, origin.z, scale.z); z++) {
+      for (uint8_t y = cell(l.y, origin.y, scale.y);
+           y <= cell(h.y, origin.y, scale.y); y++) {
+        for (uint8_t x = cell(l.x, origin.x, scale.x);
+             x <= cell(h.x, origin.x, scale.x); x++) {
+          // farthest corner of the cell decides if it is fully inside
+          Vector3 lo = origin + Vector3(x * size.x, y * size.y, z * size.z);
+          Vector3 hi = lo + size;
+          Vector3 d(fmaxf(fabsf(center.x - lo.x), fabsf(center.x - hi.x)),
+                    fmaxf(fabsf(center.y - lo.y), fabsf(center.y - hi.y)),
+                    fmaxf(fabsf(center.z - lo.z), fabsf(center.z - hi.z)));
+          visit((z * CELLS + y) * CELLS + x, d.norm() <= rr,
+                [&](const Vector3& v) { return v.inside(center, radius); },
+                f);
+        }
+      }
+    }
+  }
+
+  // All leds inside a box, low inclusive, high exclusive
+  template <class F>
+  static void box(const Vector3& l, const Vector3& h, F f) {
+    for (uint8_t z = cell(l.z, origin.z, scale.z);
+         z <= cell(h.z, origin.z, scale.z); z++) {
+      for (uint8_t y = cell(l.y, origin.y, scale.y);
+           y <= cell(h.y, origin.y, scale.y); y++) {
+        for (uint8_t x = cell(l.x, origin.x, scale.x);
+             x <= cell(h.x, origin.x, scale.x); x++) {
+          Vector3 lo = origin + Vector3(x * size.x, y * size.y, z * size.z);
+          Vector3 hi = lo + size;
+          bool inside = lo.x >= l.x && lo.y >= l.y && lo.z >= l.z &&
+                        hi.x < h.x && hi.y < h.y && hi.z < h.z;
+          visit((z * CELLS + y) * CELLS + x, inside,
+                [&](const Vector3& v) { return v.inside(l, h); }, f);
+        }
+      }
+    }
+  }
+
+  // All leds between two planes with normal n, d0 <= n.dot(led) < d1
+  template <class F>
+  static void slab(const Vector3& n, float d0, float d1, F f) {
+    // Half the extent of a cell projected on the normal
+    float e = (fabsf(n.x) * size.x + fabsf(n.y) * size.y +
+               fabsf(n.z) * size.z) / 2;
+    for (uint8_t z = 0; z < CELLS; z++) {
+      for (uint8_t y = 0; y < CELLS; y++) {
+        for (uint8_t x = 0; x < CELLS; x++) {
+          Vector3 center = origin + Vector3((x + 0.5f) * size.x,
+                                            (y + 0.5f) * size.y,
+                                            (z + 0.5f) * size.z);
+          float d = n.dot(center);
+          if (d + e < d0 || d - e >= d1) continue;
+          visit((z * CELLS + y) * CELLS + x, d - e >= d0 && d + e < d1,
+                [&](const Vector3& v) {
+                  float p = n.dot(v);
+                  return p >= d0 && p < d1;
+                },
+                f);
+        }
+      }
+    }
+  }
+};
+#endif
@@ -0,0 +1,72 @@
+#include "Layer.h"
+
+#include "power/Arena.h"
+/*------------------------------------------------------------------------------
+ * LAYER CLASS
+ *----------------------------------------------------------------------------*/
+bool Layer::lease() {
+  if (leds == nullptr) leds = Arena::lease<CRGB>(Display::PIXELS);
+  return leds != nullptr;
+}
+void Layer::release() {
+  Arena::release(leds);
+  leds = nullptr;
+}
+void Layer::clear() { fill_solid(leds, Display::PIXELS, CRGB(0, 0, 0)); }
+void Layer::fade(uint8_t i) { fadeToBlackBy(leds, Display::PIXELS, i); }
+
+void Layer::composite(Layer *const layers[], uint8_t count, CRGB *out) {
+  // Drop transparent layers so the pixel loop only sees visible ones
+  Layer *visible[LAYERS];
+  uint8_t n = 0;
+  for (uint8_t l = 0; l < count && n < LAYERS; l++) {
+    if (layers[l]->opacity) visible[n++] = layers[l];
+  }
+  if (n == 0) {
+    fill_solid(out, Display::PIXELS, CRGB(0, 0, 0));
+    return;
+  }
+  // A single opaque layer over black is a copy for all but multiply
+  if (n == 1 && visible[0]->opacity == 255 &&
+      visible[0]->blend != blend_t::MULTIPLY) {
+    memcpy(out, visible[0]->leds, Display::PIXELS * sizeof(CRGB));
+    return;
+  }
+  for (uint16_t x = 0; x < Display::PIXELS; x++) {
+    CRGB dst = CRGB(0, 0, 0);
+    for (uint8_t l = 0; l < n; l++) {
+      const Layer &layer = *visible[l];
+      CRGB src = layer.leds[x];
+      uint8_t o = layer.opacity;
+      switch (layer.blend) {
+        case blend_t::ADD:
+          if (o != 255) src.nscale8(o);
+          dst.r = qadd8(dst.r, src.r);
+          dst.g = qadd8(dst.g, src.g);
+          dst.b = qadd8(dst.b, src.b);
+          break;
+        case blend_t::MAX:
+          if (o != 255) src.nscale8(o);
+          if (src.r > dst.r) dst.r = src.r;
+          if (src.g > dst.g) dst.g = src.g;
+          if (src.b > dst.b) dst.b = src.b;
+          break;
+        case blend_t::ALPHA:
+          dst.r = dst.r + (((src.r - dst.r) * (o + 1)) >> 8);
+          dst.g = dst.g + (((src.g - dst.g) * (o + 1)) >> 8);
+          dst.b = dst.b + (((src.b - dst.b) * (o + 1)) >> 8);
+          break;
+        case blend_t::MULTIPLY:
+          // src blended towards white by 255 - opacity, then multiplied
+          src.r = 255 - scale8(255 - src.r, o);
+          src.g = 255 - scale8(255 - src.g, o);
+          src.b = 255 - scale8(255 - src.b, o);
+          dst.r = scale8(dst.r, src.r);
+          dst.g = scale8(dst.g, src.g);
+          dst.b = scale8(dst.b, src.b);
+          break;
+      }
+    }
+    out[x] = dst;
+  }
+}
@@ -0,0 +1,47 @@
+#ifndef LAYER_H
+#define LAYER_H
+#include <FastLED.h>
+#include <stdint.h>
+
+#include "core/Display.h"
+/*------------------------------------------------------------------------------
+ * LAYER CLASS
+ *------------------------------------------------------------------------------
+ * Every animation draws in its own layer. Each frame the layers of all active
+ * animations are combined into Display::leds in a single pass, bottom layer
+ * first, starting from black:
+ *
+ * ADD      dst + src * opacity, saturating
+ * MAX      brightest of dst and src * opacity per channel
+ * ALPHA    dst blended towards src by opacity
+ * MULTIPLY dst darkened by src, opacity blends between no effect and full
+ *
+ * Layers with opacity 0 are skipped.
+ *
+ * The pixels of a layer, 3 bytes per pixel, are leased from the Arena when
+ * its animation starts and released when it becomes inactive, so only the
+ * running animations hold a frame.
+ *----------------------------------------------------------------------------*/
+enum class blend_t { ADD = 0, MAX = 1, ALPHA = 2, MULTIPLY = 3 };
+
+class Layer {
+ public:
+  // Maximum amount of layers composited at once
+  static const uint8_t LAYERS = 8;
+  // Display::PIXELS pixels while leased, nullptr otherwise
+  CRGB *leds = nullptr;
+  blend_t blend = blend_t::ADD;
+  uint8_t opacity = 255;
+
+ public:
+  // Lease black pixels unless the layer has them, false when the Arena is
+  // out of memory
+  bool lease();
+  // Return the pixels to the Arena
+  void release();
+  void clear();
+  void fade(uint8_t i);
+  // Combine count layers into out, ignoring transparent layers
+  static void composite(Layer *const layers[], uint8_t count, CRGB *out);
+};
+#endif
@@ -0,0 +1,63 @@
+#include "Parallel.h"
+/*------------------------------------------------------------------------------
+ * PARALLEL STATIC DEFINITIONS
+ *----------------------------------------------------------------------------*/
+std::atomic<uint8_t> Parallel::state(IDLE);
+std::atomic<uint16_t> Parallel::next(0);
+uint16_t Parallel::count = 0;
+void (*Parallel::job)(void *, uint16_t, uint16_t) = nullptr;
+void *Parallel::context = nullptr;
+SemaphoreHandle_t Parallel::wake = nullptr;
+SemaphoreHandle_t Parallel::done = nullptr;
+/*------------------------------------------------------------------------------
+ * PARALLEL CLASS
+ *----------------------------------------------------------------------------*/
+void Parallel::begin() {
+  done = xSemaphoreCreateBinary();
+  wake = xSemaphoreCreateBinary();
+  xTaskCreatePinnedToCore(worker, "Parallel", 4096, NULL, 1, NULL, 0);
+}
+
+void Parallel::work() {
+  uint16_t begin;
+  while ((begin = next.fetch_add(CHUNK, std::memory_order_relaxed)) < count) {
+    uint16_t end = begin + CHUNK < count ? begin + CHUNK : count;
+    job(context, begin, end);
+  }
+}
+
+void Parallel::worker(void *) {
+  while (true) {
+    xSemaphoreTake(wake, portMAX_DELAY);
+    // join only the loop that woke us, a late wake up finds it closed
+    uint8_t open = OPEN;
+    if (!state.compare_exchange_strong(open, JOINED,
+                                       std::memory_order_acquire)) {
+      continue;
+    }
+    work();
+    xSemaphoreGive(done);
+  }
+}
+
+void Parallel::run(uint16_t n, void (*f)(void *, uint16_t, uint16_t),
+                   void *c) {
+  // no worker yet, run on the calling core only
+  if (wake == nullptr) {
+    f(c, 0, n);
+    return;
+  }
+  job = f;
+  context = c;
+  count = n;
+  next.store(0, std::memory_order_relaxed);
+  state.store(OPEN, std::memory_order_release);
+  xSemaphoreGive(wake);
+  work();
+  // close the loop, or sleep until the worker finishes its last chunk
+  uint8_t open = OPEN;
+  if (!state.compare_exchange_strong(open, IDLE, std::memory_order_acquire)) {
+    xSemaphoreTake(done, portMAX_DELAY);
+    state.store(IDLE, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+#include <Arduino.h>
+#include <stdint.h>
+
+#include <atomic>
+/*------------------------------------------------------------------------------
+ * PARALLEL CLASS
+ *------------------------------------------------------------------------------
+ * Splits a loop over both cores. The calling task and a worker task on core 0
+ * take chunks of CHUNK indices from a shared counter until all are taken, so
+ * a core that is busy elsewhere simply takes fewer chunks.
+ *
+ * The worker runs at priority 1, below the network task, so networking keeps
+ * core 0 whenever it needs it. If the worker does not wake up before the
+ * caller has taken all chunks it skips that loop, the caller only waits for
+ * the one chunk the worker is drawing. Chunks are small to keep that wait
+ * short, and the caller blocks instead of spinning so core 1 stays
+ * available to other tasks while the worker is preempted.
+ *
+ * Every index must be independent of the others:
+ * Parallel::each(Display::PIXELS, [&](uint16_t x) { leds[x] = ...; });
+ *----------------------------------------------------------------------------*/
+class Parallel {
+ public:
+  static const uint16_t CHUNK = 16;
+
+ private:
+  // Loop handed to the worker
+  enum state_t : uint8_t { IDLE, OPEN, JOINED };
+  static std::atomic<uint8_t> state;
+  static std::atomic<uint16_t> next;
+  static uint16_t count;
+  static void (*job)(void *context, uint16_t begin, uint16_t end);
+  static void *context;
+  static SemaphoreHandle_t wake;
+  // Given by the worker when it has finished a loop it joined
+  static SemaphoreHandle_t done;
+
+  // Take chunks until all are taken
+  static void work();
+  // Worker task on core 0
+  static void worker(void *);
+  // Run job over count indices on both cores
+  static void run(uint16_t n, void (*f)(void *, uint16_t, uint16_t), void *c);
+
+ public:
+  // Start the worker task
+  static void begin();
+  // Call f(i) for i from 0 to n, returns when all calls have finished
+  template <class F>
+  static void each(uint16_t n, F f) {
+    run(n,
+        [](void *c, uint16_t begin, uint16_t end) {
+          F &f = *(F *)c;
+          for (uint16_t i = begin; i < end; i++) f(i);
+        },
+        &f);
+  }
+};
+#endif
@@ -0,0 +1,134 @@
+#include "Recorder.h"
+
+#include <string.h>
+/*------------------------------------------------------------------------------
+ * RECORDER STATIC DEFINITIONS
+ *----------------------------------------------------------------------------*/
+FILE *Recorder::file = nullptr;
+uint8_t *Recorder::previous = nullptr;
+uint32_t Recorder::last_time = 0;
+bool Recorder::recording = false;
+uint32_t Recorder::written = 0;
+uint32_t Recorder::limit = 0;
+const char *Recorder::failure = nullptr;
+static const char MAGIC[4] = {'D', 'O', 'D', 'E'};
+static const uint8_t VERSION = 2;
+/*------------------------------------------------------------------------------
+ * RECORDER CLASS
+ *----------------------------------------------------------------------------*/
+bool Recorder::open(FILE *f) {
+  stop();
+  if (f == nullptr) return false;
+  file = f;
+  previous = new uint8_t[BYTES]();
+  return true;
+}
+
+// Write to the recording, false when the stream took less
+bool Recorder::write(const void *data, size_t size) {
+  if (fwrite(data, 1, size, file) != size) return false;
+  written += size;
+  return true;
+}
+
+void Recorder::fail(const char *reason) {
+  stop();
+  failure = reason;
+}
+
+bool Recorder::record(FILE *f, uint32_t seed, int16_t scene,
+                      uint32_t limit_) {
+  failure = nullptr;
+  if (!open(f)) return false;
+  written = 0;
+  limit = limit_;
+  uint16_t pixels = Display::PIXELS;
+  if (!write(MAGIC, sizeof(MAGIC)) || !write(&VERSION, sizeof(VERSION)) ||
+      !write(&pixels, sizeof(pixels)) || !write(&seed, sizeof(seed)) ||
+      !write(&scene, sizeof(scene))) {
+    fail("write failed");
+    return false;
+  }
+  recording = true;
+  last_time = micros();
+  return true;
+}
+
+void Recorder::capture(const CRGB *leds) {
+  if (!recording) return;
+  if (written > limit || limit - written < FRAME) {
+    fail("size limit reached");
+    return;
+  }
+  uint32_t now = micros(), dt = now - last_time;
+  last_time = now;
+  bool ok = write(&dt, sizeof(dt));
+  // previous becomes the XOR delta, runs of zeros are unchanged bytes
+  const uint8_t *current = (const uint8_t *)leds;
+  for (uint16_t i = 0; i < BYTES; i++) previous[i] ^= current[i];
+  uint16_t i = 0;
+  while (i < BYTES) {
+    uint16_t skip = 0, count = 0, zeros = 0;
+    while (i + skip < BYTES && previous[i + skip] == 0) skip++;
+    i += skip;
+    // a literal ends at the frame end or at GAP unchanged bytes
+    while (i + count < BYTES && zeros < GAP) {
+      zeros = previous[i + count++] ? 0 : zeros + 1;
+    }
+    count -= zeros;
+    ok = ok && write(&skip, sizeof(skip)) && write(&count, sizeof(count)) &&
+         write(previous + i, count);
+    i += count;
+  }
+  memcpy(previous, current, BYTES);
+  if (!ok) fail("write failed");
+}
+
+bool Recorder::play(FILE *f, uint32_t &seed, int16_t &scene) {
+  if (!open(f)) return false;
+  char magic[sizeof(MAGIC)];
+  uint8_t version;
+  uint16_t pixels;
+  if (fread(magic, sizeof(magic), 1, file) != 1 ||
+      fread(&version, sizeof(version), 1, file) != 1 ||
+      fread(&pixels, sizeof(pixels), 1, file) != 1 ||
+      fread(&seed, sizeof(seed), 1, file) != 1 ||
+      fread(&scene, sizeof(scene), 1, file) != 1 ||
+      memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION ||
+      pixels != Display::PIXELS) {
+    stop();
+    return false;
+  }
+  return true;
+}
+
+bool Recorder::next(CRGB *leds, uint32_t &dt) {
+  if (file == nullptr || fread(&dt, sizeof(dt), 1, file) != 1) return false;
+  // leds holds the literal bytes until the frame is complete
+  uint8_t *delta = (uint8_t *)leds;
+  uint16_t i = 0;
+  while (i < BYTES) {
+    uint16_t skip, count;
+    if (fread(&skip, sizeof(skip), 1, file) != 1 ||
+        fread(&count, sizeof(count), 1, file) != 1 ||
+        i + skip + count > BYTES ||
+        fread(delta + i + skip, 1, count, file) != count) {
+      return false;
+    }
+    i += skip;
+    for (uint16_t end = i + count; i < end; i++) previous[i] ^= delta[i];
+  }
+  memcpy(leds, previous, BYTES);
+  return true;
+}
+
+void Recorder::stop() {
+  if (file) fclose(file);
+  file = nullptr;
+  recording = false;
+  delete[] previous;
+  previous = nullptr;
+}
+
+bool Recorder::active() { return file != nullptr; }
+const char *Recorder::error() { return failure; }
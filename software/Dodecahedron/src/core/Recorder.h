@@ -0,0 +1,74 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+#include <FastLED.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "core/Display.h"
+/*------------------------------------------------------------------------------
+ * RECORDER CLASS
+ *------------------------------------------------------------------------------
+ * Records the composited frames with the time between them, so a run can be
+ * replayed through Display::update() or compared frame by frame.
+ *
+ * A recording starts with a header:
+ * "DODE" version:u8 pixels:u16 seed:u32 scene:i16
+ * followed by a record per frame:
+ * dt:u32 (skip:u16 count:u16 bytes[count])...
+ *
+ * Frames are stored as the XOR with the previous frame, run length encoded in
+ * skipped and literal bytes until the frame is complete. Unchanged parts of a
+ * frame cost 4 bytes per run. All values are little endian. The scene is the
+ * mqtt scene selected when the recording started, -1 for the sequence.
+ *
+ * A recording stops by itself when a write fails or the next frame could
+ * pass the size limit, error() then tells why.
+ *
+ * Recorder::record(fopen("run.rec", "wb"), seed, scene, limit);
+ * Recorder::capture(Display::leds);  // every frame
+ * Recorder::stop();
+ *----------------------------------------------------------------------------*/
+class Recorder {
+ public:
+  static const uint16_t BYTES = Display::PIXELS * sizeof(CRGB);
+
+ private:
+  // Recording or playing stream and the frame before the current one
+  static FILE *file;
+  static uint8_t *previous;
+  static uint32_t last_time;
+  // The stream is being written, not read
+  static bool recording;
+  // Runs of fewer zero bytes stay part of a literal
+  static const uint8_t GAP = 4;
+  // Largest frame record, every run but the last covers at least GAP + 1
+  // bytes and adds 4 bytes of skip and count
+  static const uint32_t FRAME = 4 + BYTES + 4 * (BYTES / (GAP + 1) + 1);
+  // Bytes written so far and the most the recording may take
+  static uint32_t written;
+  static uint32_t limit;
+  // Why the last recording stopped by itself
+  static const char *failure;
+
+  static bool open(FILE *f);
+  static bool write(const void *data, size_t size);
+  static void fail(const char *reason);
+
+ public:
+  // Start recording to f, seed is the random() seed of the run and scene the
+  // selected mqtt scene. The file stays below limit bytes.
+  static bool record(FILE *f, uint32_t seed, int16_t scene,
+                     uint32_t limit_ = UINT32_MAX);
+  // Add a frame to the recording, does nothing when not recording
+  static void capture(const CRGB *leds);
+  // Start playing f, returns the seed and scene of the recording
+  static bool play(FILE *f, uint32_t &seed, int16_t &scene);
+  // Read the next frame into leds and the microseconds before it
+  static bool next(CRGB *leds, uint32_t &dt);
+  // Stop recording or playing and close the file
+  static void stop();
+  static bool active();
+  // Why the last recording stopped by itself, nullptr when it did not
+  static const char *error();
+};
+#endif
@@ -0,0 +1,150 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+#include <stddef.h>
+#include <stdint.h>
+/******************************************************************************
+ *          How to order and travel around a rhombic dodecahedron             *
+ * ****************************************************************************
+ *                            A     A     A     A
+ *                            |     |     |     |
+ *                            B     C     D     B
+ *                           /|\   /|\   /|\   /|
+ *                         G/ | \E/ | \F/ | \G/ |
+ *                         | /H\ | /I\ | /J\ | /H
+ *                         |/   \|/   \|/   \|/
+ *                         M     K     L     M
+ *                         |     |     |     |
+ *                         N     N     N     N
+ *****************************************************************************/
+/*------------------------------------------------------------------------------
+ * TOPOLOGY TEMPLATE
+ *------------------------------------------------------------------------------
+ * Generates the edge, path, link and node tables of SOLIDS rhombic dodecahedra
+ * at compile time from one wiring order and the amount of leds on a strip.
+ *
+ * Every solid is wired with 3 strips of 8 edges, in the order of Wiring. Two
+ * consecutive edges on a strip share their corner led, so a strip holds 4
+ * pairs of STRIP / 4 leds:
+ * {0, 42}, {42, 84}, {85, 127}, {127, 169} ... for a strip of 340 leds.
+ *
+ * The tables work for any amount of solids. The display is limited by the
+ * data pins listed in Display.cpp, 6 pins drive at most 2 solids.
+ *----------------------------------------------------------------------------*/
+namespace topology {
+// Node names
+enum : uint8_t { A, B, C, D, E, F, G, H, I, J, K, L, M, N };
+
+// Fixed size array that can be filled by constexpr functions
+template <class T, size_t S>
+struct Table {
+  T data[S];
+  constexpr T& operator[](size_t i) { return data[i]; }
+  constexpr const T& operator[](size_t i) const { return data[i]; }
+};
+
+// An edge had 2 nodes mapping to 2 leds
+struct Edge {
+  uint8_t node[2];
+  uint16_t led[2];
+};
+// A node is connected to 3 or 4 other nodes
+struct Path {
+  uint8_t faces;
+  uint8_t node[4];
+};
+// A link is the edge joining two nodes and the direction to travel it
+struct Link {
+  uint8_t edge;
+  uint8_t direction;
+};
+// Cartesian coordinates of a node
+struct Point {
+  float x, y, z;
+};
+
+// Newton's method, good enough for the handful of roots below
+constexpr float root(float v) {
+  float r = v;
+  for (uint8_t i = 0; i < 32; i++) r = (r + v / r) / 2;
+  return r;
+}
+
+template <uint8_t SOLIDS, uint16_t STRIP>
+struct Topology {
+  static const uint8_t EDGES = 24;
+  static const uint8_t VERTICES = 14;
+  static const uint8_t STRIPS = 3 * SOLIDS;
+  static const uint16_t PIXELS = STRIPS * STRIP;
+  static const uint16_t PAIR = STRIP / 4;
+  static const uint16_t LENGTH = (PAIR - 1) / 2;
+  static_assert(LENGTH > 0 && LENGTH < 256, "Wisp positions are 8 bit");
+
+  // Nodes of each edge in the order they are wired, 8 edges per strip
+  static constexpr Table<Table<uint8_t, 2>, EDGES> wiring() {
+    return {{{{A, B}}, {{B, H}}, {{H, K}}, {{K, I}},  //
+             {{E, K}}, {{K, N}}, {{N, L}}, {{L, F}},  //
+             {{A, C}}, {{C, I}}, {{I, L}}, {{L, J}},  //
+             {{N, M}}, {{M, G}}, {{G, D}}, {{D, F}},  //
+             {{A, D}}, {{D, J}}, {{J, M}}, {{M, H}},  //
+             {{G, B}}, {{B, E}}, {{E, C}}, {{C, F}}}};
+  }
+
+  // Led edge mapping on each dodecahedra
+  static constexpr Table<Table<Edge, EDGES>, SOLIDS> edges() {
+    Table<Table<Edge, EDGES>, SOLIDS> t = {};
+    for (uint8_t s = 0; s < SOLIDS; s++) {
+      for (uint8_t e = 0; e < EDGES; e++) {
+        uint16_t first = (s * 3 + e / 8) * STRIP + (e % 8 / 2) * PAIR +
+                         (e % 2) * LENGTH;
+        t[s][e] = {{wiring()[e][0], wiring()[e][1]},
+                   {first, (uint16_t)(first + LENGTH)}};
+      }
+    }
+    return t;
+  }
+
+  // Paths that can be taken from each node
+  static constexpr Table<Path, VERTICES> paths() {
+    Table<Path, VERTICES> t = {};
+    for (uint8_t e = 0; e < EDGES; e++) {
+      Path& p0 = t[wiring()[e][0]];
+      Path& p1 = t[wiring()[e][1]];
+      p0.node[p0.faces++] = wiring()[e][1];
+      p1.node[p1.faces++] = wiring()[e][0];
+    }
+    return t;
+  }
+
+  // Edge and direction going from node to node, edge = EDGES if not adjacent
+  static constexpr Table<Table<Link, VERTICES>, VERTICES> links() {
+    Table<Table<Link, VERTICES>, VERTICES> t = {};
+    for (uint8_t n0 = 0; n0 < VERTICES; n0++) {
+      for (uint8_t n1 = 0; n1 < VERTICES; n1++) t[n0][n1] = {EDGES, 0};
+    }
+    for (uint8_t e = 0; e < EDGES; e++) {
+      t[wiring()[e][0]][wiring()[e][1]] = {e, 0};
+      t[wiring()[e][1]][wiring()[e][0]] = {e, 1};
+    }
+    return t;
+  }
+
+  // Cartesian coordinates with node A on top and lid to the front
+  static constexpr Table<Point, VERTICES> nodes() {
+    return {{{0, root(3) / 2, 0},                            // A
+             {0, root(3) / 3, root(6) / 3},                  // B
+             {-root(2) / 2, root(3) / 3, -root(6) / 6},      // C
+             {root(2) / 2, root(3) / 3, -root(6) / 6},       // D
+             {-root(2) / 2, root(3) / 6, root(6) / 6},       // E
+             {0, root(3) / 6, -root(6) / 3},                 // F
+             {root(2) / 2, root(3) / 6, root(6) / 6},        // G
+             {0, -root(3) / 6, root(6) / 3},                 // H
+             {-root(2) / 2, -root(3) / 6, -root(6) / 6},     // I
+             {root(2) / 2, -root(3) / 6, -root(6) / 6},      // J
+             {-root(2) / 2, -root(3) / 3, root(6) / 6},      // K
+             {0, -root(3) / 3, -root(6) / 3},                // L
+             {root(2) / 2, -root(3) / 3, root(6) / 6},       // M
+             {0, -root(3) / 2, 0}}};                         // N
+  }
+};
+}  // namespace topology
+#endif
@@ -0,0 +1,31 @@
+#include "Transition.h"
+/*------------------------------------------------------------------------------
+ * TRANSITION STATIC DEFINITIONS
+ *----------------------------------------------------------------------------*/
+Layer Transition::layer;
+Timer Transition::timer;
+float Transition::duration = 0;
+/*------------------------------------------------------------------------------
+ * TRANSITION CLASS
+ *----------------------------------------------------------------------------*/
+void Transition::begin(const CRGB *from, float seconds) {
+  duration = seconds > 0 && layer.lease() ? seconds : 0;
+  if (duration == 0) return;
+  memcpy(layer.leds, from, Display::PIXELS * sizeof(CRGB));
+  layer.blend = blend_t::ALPHA;
+  layer.opacity = 255;
+  timer = 0.0f;
+}
+
+Layer *Transition::update() {
+  if (duration == 0) return nullptr;
+  timer.update();
+  float t = timer.rt() / duration;
+  if (t >= 1) {
+    duration = 0;
+    layer.release();
+    return nullptr;
+  }
+  layer.opacity = 255 * (1 - t);
+  return &layer;
+}
@@ -0,0 +1,36 @@
+#ifndef TRANSITION_H
+#define TRANSITION_H
+#include <FastLED.h>
+#include <stdint.h>
+
+#include "core/Display.h"
+#include "core/Layer.h"
+#include "power/Timer.h"
+/*------------------------------------------------------------------------------
+ * TRANSITION CLASS
+ *------------------------------------------------------------------------------
+ * Crossfades from the last frame of a scene into the next scene. The outgoing
+ * frame is kept in a layer composited over the incoming animations with alpha
+ * blending, its opacity falls from 255 to 0 over the transition duration. The
+ * crossfade is part of the normal composite pass, it costs no extra pass.
+ * The snapshot is leased from the Arena for as long as the crossfade runs,
+ * without memory for it the scene cuts.
+ *
+ * Transition::begin(Display::leds, 1.0f);
+ * Layer *top = Transition::update();  // nullptr when finished
+ *----------------------------------------------------------------------------*/
+class Transition {
+ private:
+  // Snapshot of the outgoing frame
+  static Layer layer;
+  static Timer timer;
+  // Length of the running transition in seconds, 0 when none runs
+  static float duration;
+
+ public:
+  // Snapshot from and fade it out over seconds, 0 cuts immediately
+  static void begin(const CRGB *from, float seconds);
+  // Layer to composite on top of the animations, nullptr when finished
+  static Layer *update();
+};
+#endif
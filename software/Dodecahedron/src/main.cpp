@@ -7,15 +7,23 @@
 #include <ArduinoOTA.h>
 #include <ESPmDNS.h>
 #include <PubSubClient.h>
+#include <SPIFFS.h>
 #include <WiFi.h>
 #include <WiFiUdp.h>
 
+#include "core/Recorder.h"
+#include "power/Arena.h"
+#include "power/Pacer.h"
+#include "power/Profiler.h"
 #include "space/Animation.h"
+#include "space/Scenes.h"
 /*---------------------------------------------------------------------------------------
  * Globals
  *-------------------------------------------------------------------------------------*/
 // Global configuration parameters
 Config config;
+// Profiler probes of the frame pacing and the whole frame
+uint8_t pacer_probe, frame_probe;
 // Taskhandle for running tasks on both cores
 TaskHandle_t Task;
 void task(void *);
@@ -67,8 +75,18 @@ void setup() {
   ArduinoOTA.begin();
   Serial.print("IP address: ");
   Serial.println(WiFi.localIP());
+  // Load scenes, the built in scenes are used without a scenes file
+  if (SPIFFS.begin() && SPIFFS.exists("/scenes.json")) {
+    File file = SPIFFS.open("/scenes.json");
+    Scenes::load(file.readString().c_str());
+    file.close();
+  } else {
+    Scenes::defaults();
+  }
   // Initialize animation and display
   Animation::begin();
+  pacer_probe = Profiler::add("pacer");
+  frame_probe = Profiler::add("frame");
   // Create task1 on core 0
   xTaskCreatePinnedToCore(task, "API", 10000, NULL, 10, &Task, 0);
 }
@@ -77,15 +95,49 @@ void setup() {
  *-------------------------------------------------------------------------------------*/
 void loop() {
   static Timer fpsTimer = 1.0f;
+  static Pacer pacer = config.display.fps;
   Serial.printf("Loop: Running on core %d\n", xPortGetCoreID());
+  uint32_t frame = Profiler::start();
   while (true) {
     // Handle OTA update
     ArduinoOTA.handle();
+    // Record the frames to SPIFFS while asked to over mqtt, flash writes are
+    // slow so frames will miss their deadline while recording
+    boolean record = config.network.mqtt_values.record;
+    if (record != Recorder::active()) {
+      if (Recorder::active()) {
+        Recorder::stop();
+      } else {
+        uint32_t seed = esp_random();
+        randomSeed(seed);
+        // the old recording is replaced, so its space counts as free
+        SPIFFS.remove("/record.rec");
+        Recorder::record(fopen("/spiffs/record.rec", "wb"), seed,
+                         config.network.mqtt_values.scene,
+                         SPIFFS.totalBytes() - SPIFFS.usedBytes());
+      }
+    }
     // Run animation rountines and update the display
     Animation::animate();
+    // Stop asking for a recording that could not start or stopped itself
+    if (record && !Recorder::active()) {
+      Serial.printf("Recorder: %s\n",
+                    Recorder::error() ? Recorder::error() : "open failed");
+      config.network.mqtt_values.record = false;
+    }
+    // Yield the rest of the frame to the other tasks
+    uint32_t start = Profiler::start();
+    pacer.wait();
+    Profiler::stop(pacer_probe, start);
+    Profiler::stop(frame_probe, frame);
+    frame = Profiler::start();
     // Print FPS once every second
     if (fpsTimer.update()) {
-      Serial.printf("FPS=%1.2f\n", Animation::fps());
+      Serial.printf(
+          "FPS=%1.2f Missed=%u Load=%u%% Skipped=%u Output=%uus Power=%umA\n",
+          Animation::fps(), pacer.missed(), (unsigned)(pacer.load() * 100),
+          Display::skipped(), (unsigned)Display::output(),
+          (unsigned)Display::power());
     }
   }
 }
@@ -99,6 +151,9 @@ void task(void *parameter) {
   HttpClient httpclient = HttpClient(wifi_1, config.network.hue_ip, 80);
   PubSubClient mqttclient(wifi_2);
   mqttclient.setServer(config.network.broker_ip, 1883);
+  mqttclient.setBufferSize(1024);
+  Timer profileTimer = config.display.profile_interval;
+  char profile[768];
   String hue_api = config.network.hue_api;
 
   mqttclient.setCallback([](char *topic_, byte *payload, unsigned int length) {
@@ -121,6 +176,8 @@ void task(void *parameter) {
       config.network.mqtt_values.color = CRGB(CHSV(hue, sat, 255));
     } else if (topic.equals(config.network.mqtt_topics.scene)) {
       config.network.mqtt_values.scene = response.toInt();
+    } else if (topic.equals(config.network.mqtt_topics.record)) {
+      config.network.mqtt_values.record = response == "true";
     }
   });
 
@@ -150,6 +207,7 @@ void task(void *parameter) {
         mqttclient.subscribe(config.network.mqtt_topics.dim);
         mqttclient.subscribe(config.network.mqtt_topics.color);
         mqttclient.subscribe(config.network.mqtt_topics.scene);
+        mqttclient.subscribe(config.network.mqtt_topics.record);
       } else {
         Serial.printf("Can't Subcribe\n");
       }
@@ -159,7 +217,23 @@ void task(void *parameter) {
     }
   };
 
+  // Publish the frame time histograms collected on core 1 and the arena use
+  auto handleProfile = [&]() {
+    Profiler::drain();
+    if (profileTimer.update()) {
+      size_t n = Profiler::report(profile, sizeof(profile));
+      snprintf(profile + n, sizeof(profile) - n,
+               "arena used=%u peak=%u size=%u\n", (unsigned)Arena::used(),
+               (unsigned)Arena::peak(), (unsigned)Arena::SIZE);
+      Serial.print(profile);
+      if (mqttclient.connected()) {
+        mqttclient.publish(config.network.mqtt_topics.profile, profile);
+      }
+    }
+  };
+
   while (true) {
+    handleProfile();
     if (WiFi.status() != WL_CONNECTED) {
       WiFi.reconnect();
     } else {
@@ -167,6 +241,7 @@ void task(void *parameter) {
         handleHTTP(config.lights.light[i]);
         vTaskDelay(1);
         handleMQTT();
+        handleProfile();
         vTaskDelay(1);
       }
     }
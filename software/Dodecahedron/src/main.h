@@ -5,6 +5,7 @@
 
 #include "ArduinoJson.h"
 #include "FastLED.h"
+#include "core/Display.h"
 /*-----------------------------------------------------------------------------
  * Evil global Config parameters
  *
@@ -26,17 +27,42 @@ struct Config {
       char dim[64] = "homey/dodecahedron/dim";
       char color[64] = "homey/dodecahedron/color";
       char scene[64] = "homey/dodecahedron/scene";
+      char profile[64] = "homey/dodecahedron/profile";
+      char record[64] = "homey/dodecahedron/record";
     } mqtt_topics;
     struct {
       boolean onoff = false;
       uint8_t dim = 255;
       int16_t scene = -1;
+      boolean record = false;
       CRGB color = CRGB(255, 150, 30);
     } mqtt_values;
   } network;
   struct {
-    uint16_t angle_solid_0 = 0;
-    uint16_t angle_solid_1 = 0;
+    // target frame rate of the animation loop, 0 runs unpaced
+    float fps = 60.0f;
+    // seconds to crossfade into a scene selected over mqtt, 0 cuts
+    float transition = 1.0f;
+    // seconds between frame time reports over serial and mqtt
+    float profile_interval = 10.0f;
+    // output gamma, render buffers stay linear
+    float gamma = 2.2f;
+    // white balance, full scale output level of each channel
+    CRGB white = CRGB(255, 255, 255);
+    // temporal dithering of the fraction left after gamma correction
+    boolean dither = true;
+    // current model of a led and the budget of the power supply
+    struct {
+      uint16_t red_ma = 16;
+      uint16_t green_ma = 11;
+      uint16_t blue_ma = 15;
+      uint16_t idle_ma = 1;
+      uint32_t budget_ma = 20000;
+    } power;
+  } display;
+  struct {
+    // rotation of each solid around its vertical axis in degrees
+    uint16_t angle_solid[DISPLAY_DODECAHEDRA] = {};
   } calibration;
   struct {
     float timer_duration = 15.0f;
@@ -54,6 +80,9 @@ struct Config {
     float timer_duration = 20.0f;
     float timer_interval = 0.022f;
     uint8_t fade_out_amount = 5;
+    // amount of wisps and how much their speed differs in percent
+    uint16_t wisps = 6;
+    uint8_t spread = 0;
   } trails;
   struct {
     const uint8_t lights = 6;
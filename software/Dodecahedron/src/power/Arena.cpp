@@ -0,0 +1,49 @@
+#include "Arena.h"
+
+#include <string.h>
+/*------------------------------------------------------------------------------
+ * ARENA STATIC DEFINITIONS
+ *----------------------------------------------------------------------------*/
+// The pool starts as a single free block
+uint32_t Arena::pool[SIZE / 4] = {SIZE};
+uint32_t Arena::in_use = 0;
+uint32_t Arena::high_water = 0;
+/*------------------------------------------------------------------------------
+ * ARENA CLASS
+ *----------------------------------------------------------------------------*/
+void *Arena::lease(size_t size) {
+  uint32_t need = (size + 4 + 3) & ~3UL;
+  for (uint32_t w = 0; w < SIZE / 4; w += (pool[w] & ~1UL) / 4) {
+    uint32_t block = pool[w];
+    if (block & 1 || block < need) continue;
+    // split when the rest can hold a header and a word
+    if (block - need >= 8) {
+      pool[w + need / 4] = block - need;
+      block = need;
+    }
+    pool[w] = block | 1;
+    in_use += block;
+    if (in_use > high_water) high_water = in_use;
+    memset(&pool[w + 1], 0, block - 4);
+    return &pool[w + 1];
+  }
+  return nullptr;
+}
+
+void Arena::release(void *memory) {
+  if (memory == nullptr) return;
+  uint32_t *header = (uint32_t *)memory - 1;
+  *header &= ~1UL;
+  in_use -= *header;
+  // merge all runs of free blocks
+  for (uint32_t w = 0; w < SIZE / 4; w += pool[w] / 4) {
+    if (pool[w] & 1) continue;
+    uint32_t next;
+    while ((next = w + pool[w] / 4) < SIZE / 4 && !(pool[next] & 1)) {
+      pool[w] += pool[next];
+    }
+  }
+}
+
+uint32_t Arena::used() { return in_use; }
+uint32_t Arena::peak() { return high_water; }
@@ -0,0 +1,51 @@
+#ifndef ARENA_H
+#define ARENA_H
+#include <stddef.h>
+#include <stdint.h>
+/*------------------------------------------------------------------------------
+ * ARENA CLASS
+ *------------------------------------------------------------------------------
+ * Fixed memory pool that running animations lease their layer and state
+ * from, so only the animations that are running hold memory. Leases are first fit, every
+ * block carries a 4 byte header and released neighbours merge again. Leased
+ * memory is zeroed. The high water mark shows how much of the pool the
+ * busiest scene needed.
+ *
+ * The pool itself is a static reservation of ARENA_SIZE bytes. It has to
+ * hold the busiest scene, its layers and the transition snapshot included,
+ * instead of a frame per animation. The default fits two layered animations
+ * and a transition.
+ *
+ * Leases and releases happen from the animation loop only:
+ * CRGB *buffer = Arena::lease<CRGB>(Display::PIXELS);
+ * Arena::release(buffer);
+ *----------------------------------------------------------------------------*/
+#ifndef ARENA_SIZE
+#define ARENA_SIZE 24576
+#endif
+
+class Arena {
+ public:
+  static const uint32_t SIZE = ARENA_SIZE;
+  static_assert(SIZE % 4 == 0, "The pool is made of 4 byte words");
+
+ private:
+  // Blocks start with a header of their size in bytes, bit 0 marks a lease
+  static uint32_t pool[SIZE / 4];
+  static uint32_t in_use;
+  static uint32_t high_water;
+
+ public:
+  // Lease size bytes, returns nullptr if no free block is large enough
+  static void *lease(size_t size);
+  template <class T>
+  static T *lease(size_t count) {
+    return (T *)lease(count * sizeof(T));
+  }
+  // Return a lease to the pool, nullptr is ignored
+  static void release(void *memory);
+  // Bytes leased now and at most since boot, headers included
+  static uint32_t used();
+  static uint32_t peak();
+};
+#endif
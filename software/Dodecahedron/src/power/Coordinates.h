@@ -0,0 +1,46 @@
+#ifndef COORDINATES_H
+#define COORDINATES_H
+#include <stdint.h>
+
+#include "Math3D.h"
+/*------------------------------------------------------------------------------
+ * COORDINATES CLASS
+ *------------------------------------------------------------------------------
+ * Stores N points as separate x, y and z arrays of signed 16 bit fixed point
+ * values, with SHIFT fractional bits. That is 6 bytes per point instead of 12
+ * for a Vector3 and the range is -8.0 to 8.0 with a resolution of 1/4096.
+ *
+ * Effects projecting all points on a direction can use dot() to stay in
+ * integer math:
+ * hue = coordinates.dot(i, 50, 100, 400) >> Coordinates<N>::SHIFT;
+ *----------------------------------------------------------------------------*/
+template <uint16_t N>
+class Coordinates {
+ public:
+  static const uint8_t SHIFT = 12;
+  static const int32_t ONE = 1 << SHIFT;
+  int16_t x[N];
+  int16_t y[N];
+  int16_t z[N];
+
+ public:
+  // Convert between float and fixed point
+  static int16_t fixed(float f) { return f * ONE + (f < 0 ? -0.5f : 0.5f); }
+  static float real(int16_t q) { return q / (float)ONE; }
+
+  // Store and load a point as a vector
+  void set(uint16_t i, const Vector3& v) {
+    x[i] = fixed(v.x);
+    y[i] = fixed(v.y);
+    z[i] = fixed(v.z);
+  }
+  Vector3 operator[](uint16_t i) const {
+    return Vector3(real(x[i]), real(y[i]), real(z[i]));
+  }
+
+  // Dot product of point i and an integer direction, scaled by ONE
+  int32_t dot(uint16_t i, int16_t dx, int16_t dy, int16_t dz) const {
+    return (int32_t)x[i] * dx + (int32_t)y[i] * dy + (int32_t)z[i] * dz;
+  }
+};
+#endif
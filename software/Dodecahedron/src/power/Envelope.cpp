@@ -0,0 +1,51 @@
+#include "Envelope.h"
+
+#include <math.h>
+/*------------------------------------------------------------------------------
+ * ENVELOPE CLASS
+ *----------------------------------------------------------------------------*/
+void Envelope::shape(curve_t curve) {
+  for (uint16_t i = 0; i < 256; i++) {
+    // position within the rise or the decay, 0 to 1
+    float x = (i & 127) / 128.0f;
+    float y;
+    if (i < 128) {
+      switch (curve) {
+        case curve_t::EASE:
+          y = x * x * (3 - 2 * x);
+          break;
+        case curve_t::SPARKLE:
+          y = sqrtf(x);
+          break;
+        default:
+          y = x;
+          break;
+      }
+    } else {
+      switch (curve) {
+        case curve_t::EASE:
+          y = 1 - x * x * (3 - 2 * x);
+          break;
+        case curve_t::DECAY:
+          y = (expf(-5 * x) - expf(-5)) / (1 - expf(-5));
+          break;
+        case curve_t::SPARKLE:
+          y = (1 - x) * (1 - x) * (0.6f + 0.4f * cosf(x * 12 * (float)M_PI));
+          break;
+        default:
+          y = 1 - x;
+          break;
+      }
+    }
+    table[i] = 255 * y;
+  }
+}
+
+void Envelope::frame(float rise_time, float decay_time, float dt) {
+  // half the phase range per envelope part, rounded so short envelopes do
+  // not run long, at least one step per frame
+  float r = rise_time > 0 ? 0x8000 * dt / rise_time + 0.5f : 0x8000;
+  float d = decay_time > 0 ? 0x8000 * dt / decay_time + 0.5f : 0x8000;
+  rise = r < 1 ? 1 : r > 0x8000 ? 0x8000 : r;
+  decay = d < 1 ? 1 : d > 0x8000 ? 0x8000 : d;
+}
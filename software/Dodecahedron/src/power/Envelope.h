@@ -0,0 +1,49 @@
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+#include <stdint.h>
+/*------------------------------------------------------------------------------
+ * ENVELOPE CLASS
+ *------------------------------------------------------------------------------
+ * Brightness envelope of a rise followed by a decay, driven by a 16 bit phase
+ * per pixel. The lower half of the phase is the rise and the upper half the
+ * decay, the brightness is looked up in a 256 entry table of the curve. The
+ * increments of both halves are computed once per frame, so advancing and
+ * looking up a pixel is integer only.
+ *
+ * LINEAR   straight rise and decay
+ * EASE     smoothstep rise and decay
+ * DECAY    straight rise, exponential decay
+ * SPARKLE  fast rise, decay with a flicker on top
+ *
+ * Envelope e;
+ * e.shape(curve_t::EASE);
+ * e.frame(1.0f, 2.0f, dt);                 // rise, decay seconds, frame time
+ * uint8_t level = e.level(phase);
+ * if (!e.step(phase)) ...                  // the envelope has ended
+ *----------------------------------------------------------------------------*/
+enum class curve_t : uint8_t { LINEAR, EASE, DECAY, SPARKLE };
+
+class Envelope {
+ private:
+  uint8_t table[256];
+  // Phase increment per frame of the rise and the decay
+  uint16_t rise = 0x8000;
+  uint16_t decay = 0x8000;
+
+ public:
+  Envelope() { shape(curve_t::LINEAR); }
+  // Fill the table with a curve
+  void shape(curve_t curve);
+  // Set the increments of this frame from the rise and decay times
+  void frame(float rise_time, float decay_time, float dt);
+  // Brightness at phase
+  uint8_t level(uint16_t phase) const { return table[phase >> 8]; }
+  // Advance phase by a frame, returns false when the envelope has ended
+  bool step(uint16_t &phase) const {
+    uint32_t next = (uint32_t)phase + (phase < 0x8000 ? rise : decay);
+    if (next > 0xFFFF) return false;
+    phase = next;
+    return true;
+  }
+};
+#endif
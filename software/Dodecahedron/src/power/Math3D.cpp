@@ -210,4 +210,29 @@ Vector3 Quaternion::rotate(const Vector3& v) const {
   Quaternion p = Quaternion(0, v);
   // multiply (p)(q)(pi) and return vector part
   return ((*this) * p * (*this).inversed()).v;
-}
\ No newline at end of file
+}
+
+/*------------------------------------------------------------------------------
+ * Matrix3 CLASS
+ *----------------------------------------------------------------------------*/
+Matrix3::Matrix3() : m{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}} {}
+// Rotation matrix of a unit quaternion
+Matrix3::Matrix3(const Quaternion& q) {
+  float w = q.w, x = q.v.x, y = q.v.y, z = q.v.z;
+  m[0][0] = 1 - 2 * (y * y + z * z);
+  m[0][1] = 2 * (x * y - w * z);
+  m[0][2] = 2 * (x * z + w * y);
+  m[1][0] = 2 * (x * y + w * z);
+  m[1][1] = 1 - 2 * (x * x + z * z);
+  m[1][2] = 2 * (y * z - w * x);
+  m[2][0] = 2 * (x * z - w * y);
+  m[2][1] = 2 * (y * z + w * x);
+  m[2][2] = 1 - 2 * (x * x + y * y);
+}
+
+// rotate v by this matrix
+Vector3 Matrix3::operator*(const Vector3& v) const {
+  return Vector3(m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+                 m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+                 m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z);
+}
@@ -0,0 +1,43 @@
+#include "Pacer.h"
+/*------------------------------------------------------------------------------
+ * PACER CLASS
+ *----------------------------------------------------------------------------*/
+Pacer::Pacer() { operator=(0); }
+Pacer::Pacer(const float fps) { operator=(fps); }
+void Pacer::operator=(const float fps) {
+  m_period = fps > 0 ? 1000000.0f / fps : 0;
+  m_frameTime = micros();
+  m_deadline = m_frameTime + m_period;
+  m_busyTime = 0;
+  m_missedCount = 0;
+}
+bool Pacer::wait() {
+  unsigned long now = micros();
+  m_busyTime += now - m_frameTime;
+  bool met = !m_period || (long)(m_deadline - now) >= 0;
+  if (m_period && met) {
+    // sleep whole ticks and spin the rest. Rounding down keeps the delay
+    // itself short of the deadline, but a higher priority task can still run
+    // when it ends and make this frame late, which missed() then counts.
+    unsigned long ticks = (m_deadline - now) / (1000 * portTICK_PERIOD_MS);
+    if (ticks) vTaskDelay(ticks);
+    while ((long)(m_deadline - micros()) > 0) {
+    }
+    m_deadline += m_period;
+  } else if (m_period) {
+    m_missedCount++;
+    // a little late keeps the phase, a period behind restarts the schedule
+    m_deadline += m_period;
+    if ((long)(m_deadline - now) < 0) m_deadline = now + m_period;
+  }
+  m_frameTime = micros();
+  if (m_rateTimer.update()) {
+    m_missedRate = m_missedCount;
+    m_missedCount = 0;
+    m_load = m_busyTime / 1000000.0f;
+    m_busyTime = 0;
+  }
+  return met;
+}
+uint16_t Pacer::missed() const { return m_missedRate; }
+float Pacer::load() const { return m_load; }
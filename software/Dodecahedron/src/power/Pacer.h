@@ -0,0 +1,47 @@
+#ifndef PACER_H
+#define PACER_H
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "Timer.h"
+/*------------------------------------------------------------------------------
+ * PACER CLASS
+ *------------------------------------------------------------------------------
+ * Paces a loop to a fixed frame rate. Every frame has a deadline one period
+ * after the previous one, wait() sleeps until it so lower priority tasks and
+ * the idle task get the time left over. Whole ticks are slept with vTaskDelay,
+ * the last part of a tick is spun on micros().
+ *
+ * A frame finishing after its deadline is counted as missed. The schedule
+ * keeps its phase when a frame is a little late, more than a period behind it
+ * restarts from now instead of rushing frames to catch up.
+ *
+ * Paces a loop at 60 frames per second, 0 runs unpaced:
+ * Pacer pacer = 60.0f;
+ * while (true) { draw(); pacer.wait(); }
+ *----------------------------------------------------------------------------*/
+class Pacer {
+ public:
+  Pacer();
+  Pacer(const float fps);
+  void operator=(const float fps);
+  // Wait for the next deadline, returns false if it was already missed
+  bool wait();
+  // Missed deadlines in the last second
+  uint16_t missed() const;
+  // Part of the frame period spent working in the last second, 0 to 1
+  float load() const;
+
+ private:
+  // frame period and deadline of the current frame in microseconds
+  unsigned long m_period = 0;
+  unsigned long m_deadline = 0;
+  // start of the current frame and the time worked in this second
+  unsigned long m_frameTime = 0;
+  unsigned long m_busyTime = 0;
+  uint16_t m_missedCount = 0;
+  uint16_t m_missedRate = 0;
+  float m_load = 0;
+  Timer m_rateTimer = 1.0f;
+};
+#endif
@@ -0,0 +1,97 @@
+#include "Profiler.h"
+
+#include <stdio.h>
+#include <string.h>
+/*------------------------------------------------------------------------------
+ * PROFILER STATIC DEFINITIONS
+ *----------------------------------------------------------------------------*/
+uint32_t Profiler::ring[RING];
+std::atomic<uint16_t> Profiler::head(0);
+std::atomic<uint16_t> Profiler::tail(0);
+std::atomic<uint32_t> Profiler::dropped(0);
+const char *Profiler::names[PROBES];
+uint8_t Profiler::probes = 0;
+uint16_t Profiler::histogram[PROBES][BUCKETS];
+uint32_t Profiler::maximum[PROBES];
+/*------------------------------------------------------------------------------
+ * PROFILER CLASS
+ *----------------------------------------------------------------------------*/
+uint8_t Profiler::bucket(uint32_t cycles) {
+  if (cycles < 4) return cycles;
+  uint8_t msb = 31 - __builtin_clz(cycles);
+  return msb * 4 + ((cycles >> (msb - 2)) & 3);
+}
+
+uint32_t Profiler::bound(uint8_t bucket) {
+  if (bucket < 8) return bucket + 1;
+  uint8_t msb = bucket / 4;
+  return (4 + bucket % 4 + 1) << (msb - 2);
+}
+
+uint32_t Profiler::percentile(uint8_t probe, uint32_t total, uint8_t rank) {
+  uint32_t n = (total * rank + 99) / 100, count = 0;
+  for (uint8_t b = 0; b < BUCKETS; b++) {
+    count += histogram[probe][b];
+    if (count >= n) return bound(b);
+  }
+  return maximum[probe];
+}
+
+uint8_t Profiler::add(const char *name) {
+  if (probes == PROBES) return PROBES - 1;
+  names[probes] = name;
+  return probes++;
+}
+
+void Profiler::stop(uint8_t probe, uint32_t start) {
+  uint32_t cycles = ESP.getCycleCount() - start;
+  if (cycles >= 1UL << 27) cycles = (1UL << 27) - 1;
+  uint16_t h = head.load(std::memory_order_relaxed);
+  uint16_t next = (h + 1) % RING;
+  // full, the consumer is behind
+  if (next == tail.load(std::memory_order_acquire)) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  ring[h] = (uint32_t)probe << 27 | cycles;
+  head.store(next, std::memory_order_release);
+}
+
+void Profiler::drain() {
+  uint16_t t = tail.load(std::memory_order_relaxed);
+  uint16_t h = head.load(std::memory_order_acquire);
+  while (t != h) {
+    uint8_t probe = ring[t] >> 27;
+    uint32_t cycles = ring[t] & ((1UL << 27) - 1);
+    uint16_t &count = histogram[probe][bucket(cycles)];
+    if (count < UINT16_MAX) count++;
+    if (cycles > maximum[probe]) maximum[probe] = cycles;
+    t = (t + 1) % RING;
+  }
+  tail.store(t, std::memory_order_release);
+}
+
+size_t Profiler::report(char *buffer, size_t size) {
+  drain();
+  float mhz = getCpuFrequencyMhz();
+  size_t length = 0;
+  for (uint8_t p = 0; p < probes && length < size; p++) {
+    uint32_t total = 0;
+    for (uint8_t b = 0; b < BUCKETS; b++) total += histogram[p][b];
+    if (total) {
+      length += snprintf(buffer + length, size - length,
+                         "%s n=%u p50=%.1fus p99=%.1fus max=%.1fus\n",
+                         names[p], (unsigned)total,
+                         percentile(p, total, 50) / mhz,
+                         percentile(p, total, 99) / mhz, maximum[p] / mhz);
+    }
+    memset(histogram[p], 0, sizeof(histogram[p]));
+    maximum[p] = 0;
+  }
+  uint32_t lost = dropped.exchange(0, std::memory_order_relaxed);
+  if (lost && length < size) {
+    length += snprintf(buffer + length, size - length, "dropped=%u\n",
+                       (unsigned)lost);
+  }
+  return length < size ? length : size - 1;
+}
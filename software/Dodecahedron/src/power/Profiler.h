@@ -0,0 +1,60 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <Arduino.h>
+#include <stdint.h>
+
+#include <atomic>
+/*------------------------------------------------------------------------------
+ * PROFILER CLASS
+ *------------------------------------------------------------------------------
+ * Measures sections of the animation loop in cpu cycles. Every measurement is
+ * pushed into a single producer single consumer ring without locks, so timing
+ * the loop on core 1 never waits for the network task on core 0. The network
+ * task drains the ring into a histogram per probe and reports the median,
+ * 99th percentile and maximum of each probe since the previous report.
+ *
+ * Histogram buckets are powers of two split in 4, so percentiles are within
+ * 25% of the measured time at any scale.
+ *
+ * Probes are added once at startup and measured around a section:
+ * static uint8_t probe = Profiler::add("update");
+ * uint32_t start = Profiler::start();
+ * Display::update();
+ * Profiler::stop(probe, start);
+ *----------------------------------------------------------------------------*/
+class Profiler {
+ public:
+  static const uint8_t PROBES = 16;
+  static const uint8_t BUCKETS = 4 * 27;
+  static const uint16_t RING = 1024;
+
+ private:
+  // Samples hold the probe in the upper 5 bits and cycles in the lower 27
+  static uint32_t ring[RING];
+  static std::atomic<uint16_t> head;
+  static std::atomic<uint16_t> tail;
+  static std::atomic<uint32_t> dropped;
+  // Probe names and their histograms since the last report
+  static const char *names[PROBES];
+  static uint8_t probes;
+  static uint16_t histogram[PROBES][BUCKETS];
+  static uint32_t maximum[PROBES];
+
+  // Bucket of a cycle count and the upper bound of a bucket
+  static uint8_t bucket(uint32_t cycles);
+  static uint32_t bound(uint8_t bucket);
+  // Cycles below which rank percent of the samples of a probe fall
+  static uint32_t percentile(uint8_t probe, uint32_t total, uint8_t rank);
+
+ public:
+  // Add a probe, returns its id
+  static uint8_t add(const char *name);
+  // Start and stop a measurement, only call these from a single task
+  static uint32_t start() { return ESP.getCycleCount(); }
+  static void stop(uint8_t probe, uint32_t start);
+  // Move all measurements from the ring into the histograms
+  static void drain();
+  // Write a report of all probes and clear the histograms, returns the length
+  static size_t report(char *buffer, size_t size);
+};
+#endif
@@ -1,9 +1,12 @@
 #include "Animation.h"
 
+#include "Animations.h"
 #include "FastLED.h"
-#include "Flux.h"
-#include "Trails.h"
-#include "Twinkels.h"
+#include "Scenes.h"
+#include "core/Parallel.h"
+#include "core/Recorder.h"
+#include "core/Transition.h"
+#include "power/Profiler.h"
 /*------------------------------------------------------------------------------
  * ANIMATION STATIC DEFINITIONS
  *----------------------------------------------------------------------------*/
@@ -13,40 +16,60 @@ uint16_t Animation::animation_sequence = 0;
 /*------------------------------------------------------------------------------
  * GLOBAL DEFINITIONS
  *----------------------------------------------------------------------------*/
-Twinkels twinkels;
-Trails trails;
-Flux flux;
-Animation *Animations[] = {&twinkels, &trails, &flux};
+static Animations animations;
+// Profiler probes of each animation, the compositor and the display
+static uint8_t draw_probe[Animations::SIZE];
+static uint8_t composite_probe, update_probe;
 /*----------------------------------------------------------------------------*/
-void Animation::begin() { Display::begin(); }
+void Animation::begin() {
+  for (uint8_t i = 0; i < Animations::SIZE; i++) {
+    draw_probe[i] = Profiler::add(Animations::name(i));
+  }
+  composite_probe = Profiler::add("composite");
+  update_probe = Profiler::add("update");
+  Parallel::begin();
+  Display::begin();
+}
 
 // Render an animation frame from all active animations
 void Animation::animate() {
   // Update the animation timer to determine frame deltatime
   animation_timer.update();
+  // A selected scene replaces the running one right away, crossfading from
+  // the last frame instead of waiting for each animation to end
+  if (config.network.mqtt_values.scene >= 0) {
+    Transition::begin(Display::leds, config.display.transition);
+    select();
+  }
   // Draw all active animations from the animation pool
   uint8_t active_count = 0;
-  for (uint8_t i = 0; i < sizeof(Animations) / sizeof(Animation *); i++) {
-    Animation &animation = *Animations[i];
-    if (animation.task != task_state_t::INACTIVE) {
-      animation.draw(animation_timer.dt());
-    }
+  uint8_t layer_count = 0;
+  Layer *layers[Animations::SIZE + 1];
+  animations.each([&](auto &animation, uint8_t i) {
+    if (animation.task == task_state_t::INACTIVE) return;
+    uint32_t start = Profiler::start();
+    animation.draw(animation_timer.dt());
+    Profiler::stop(draw_probe[i], start);
     if (animation.task != task_state_t::INACTIVE) {
+      layers[layer_count++] = &animation.layer;
       active_count++;
-      if (config.network.mqtt_values.scene >= 0) {
-        animation.end();
-      }
-    }
-  }
-  if (active_count == 0) {
-    if (config.network.mqtt_values.scene >= 0) {
-      select();
     } else {
-      next();
+      animation.release();
+      animation.layer.release();
     }
-  }
-  // Commit current animation frame to the display
+  });
+  if (active_count == 0) next();
+  // The outgoing frame fades out on top of everything
+  Layer *transition = Transition::update();
+  if (transition) layers[layer_count++] = transition;
+  // Combine the layers and commit the animation frame to the display
+  uint32_t start = Profiler::start();
+  Layer::composite(layers, layer_count, Display::leds);
+  Profiler::stop(composite_probe, start);
+  Recorder::capture(Display::leds);
+  start = Profiler::start();
   Display::update();
+  Profiler::stop(update_probe, start);
 }
 
 // Get fps, if animate has been called t > 0
@@ -57,110 +80,41 @@ float Animation::fps() {
   return 0;
 }
 
-void SEQ_TWINKEL_WHITE_00(void) {
-  twinkels.clear();
-  twinkels.init(config.twinkels.timer_duration, true, true);
-  twinkels.speed(config.twinkels.fade_in_speed, config.twinkels.fade_out_speed);
-  twinkels.color(CRGB(255, 150, 30));
-}
-void SEQ_TWINKEL_HUE_00(void) {
-  twinkels.init(config.twinkels.timer_duration, true);
-  twinkels.speed(config.twinkels.fade_in_speed, config.twinkels.fade_out_speed);
-  twinkels.color(0);
-}
-void SEQ_TWINKEL_HUE_01(void) {
-  twinkels.init(config.twinkels.timer_duration, true);
-  twinkels.speed(config.twinkels.fade_in_speed, config.twinkels.fade_out_speed);
-  twinkels.color(1);
-}
-void SEQ_TWINKEL_HUE_02(void) {
-  twinkels.init(config.twinkels.timer_duration, true);
-  twinkels.speed(config.twinkels.fade_in_speed, config.twinkels.fade_out_speed);
-  twinkels.color(2);
-}
-void SEQ_TWINKEL_HUE_03(void) {
-  twinkels.init(config.twinkels.timer_duration, true);
-  twinkels.speed(config.twinkels.fade_in_speed, config.twinkels.fade_out_speed);
-  twinkels.color(3);
-}
-void SEQ_TWINKEL_HUE_04(void) {
-  twinkels.init(config.twinkels.timer_duration, true);
-  twinkels.speed(config.twinkels.fade_in_speed, config.twinkels.fade_out_speed);
-  twinkels.color(4);
-}
-void SEQ_TWINKEL_HUE_05(void) {
-  twinkels.init(config.twinkels.timer_duration, true);
-  twinkels.speed(config.twinkels.fade_in_speed, config.twinkels.fade_out_speed);
-  twinkels.color(5);
-}
-void SEQ_TWINKEL_MULTI_00(void) {
-  twinkels.init(config.twinkels.timer_duration);
-  twinkels.speed(config.twinkels.fade_in_speed, config.twinkels.fade_out_speed);
-}
-void SEQ_TWINKEL_MULTI_01(void) {
-  twinkels.init(config.twinkels.timer_duration, false, false, false, true);
-  twinkels.speed(config.twinkels.fade_in_speed / 2,
-                 config.twinkels.fade_out_speed / 2);
-}
-void SEQ_TRAILS_HUE_00(void) {
-  trails.init(config.trails.timer_duration, true);
-  trails.speed(config.trails.timer_interval, config.trails.fade_out_amount);
-}
-void SEQ_FLUX_00(void) {
-  flux.init(config.flux.timer_duration, config.flux.x_movement,
-            config.flux.y_movement, config.flux.z_movement);
-}
-void SEQ_TWINKEL_MQTT_00(void) {
-  twinkels.init(config.twinkels.timer_duration, true, false, false, false,
-                true);
-  twinkels.speed(config.twinkels.fade_in_speed, config.twinkels.fade_out_speed);
+// Stop all animations and start the animations of a scene
+void Animation::start(Scenes::list_t list, uint8_t index) {
+  animations.each([](auto &animation, uint8_t) {
+    animation.stop();
+    animation.release();
+    animation.layer.release();
+  });
+  uint8_t n;
+  const Scene *scene = Scenes::get(list, index, n);
+  for (uint8_t i = 0; i < n; i++) {
+    animations.visit(scene[i].animation, [&](auto &animation) {
+      if (animation.layer.lease()) {
+        animation.start(scene[i]);
+      } else {
+        Serial.printf("%s: out of arena memory\n", animation.NAME);
+      }
+    });
+  }
 }
 
-// Animation sequencer jumptable implementation
+// Animation sequencer, plays the sequence scenes in order
 void Animation::next() {
-  static void (*jump_table[])() =  //
-      {&SEQ_TWINKEL_WHITE_00, &SEQ_TWINKEL_MQTT_00, &SEQ_TWINKEL_HUE_00,
-       &SEQ_TWINKEL_HUE_01,   &SEQ_TWINKEL_HUE_02,  &SEQ_TWINKEL_HUE_03,
-       &SEQ_TWINKEL_HUE_04,   &SEQ_TWINKEL_HUE_05,  &SEQ_TWINKEL_MULTI_00,
-       &SEQ_TWINKEL_MULTI_01, &SEQ_TRAILS_HUE_00,   &SEQ_FLUX_00};
-  if (animation_sequence >= sizeof(jump_table) / sizeof(void *)) {
+  if (Scenes::size(Scenes::SEQUENCE) == 0) return;
+  if (animation_sequence >= Scenes::size(Scenes::SEQUENCE)) {
     animation_sequence = 0;
   }
-  jump_table[animation_sequence++]();
+  start(Scenes::SEQUENCE, animation_sequence++);
 }
 
-void SEL_TWINKEL_WHITE_00(void) {
-  twinkels.clear();
-  twinkels.init(0, true, true);
-  twinkels.speed(config.twinkels.fade_in_speed, config.twinkels.fade_out_speed);
-  twinkels.color(CRGB(255, 150, 30));
-}
-void SEL_TWINKEL_MQTT_00(void) {
-  twinkels.init(0, true, false, false, false, true);
-  twinkels.speed(config.twinkels.fade_in_speed, config.twinkels.fade_out_speed);
-}
-void SEL_FLUX_00(void) {
-  flux.init(0, config.flux.x_movement, config.flux.y_movement,
-            config.flux.z_movement);
-}
-void SEL_TRAILS_HUE_00(void) {
-  trails.init(0, true);
-  trails.speed(config.trails.timer_interval, config.trails.fade_out_amount);
-}
-void SEL_TWINKEL_MULTI_00(void) {
-  twinkels.init(0);
-  twinkels.speed(config.twinkels.fade_in_speed, config.twinkels.fade_out_speed);
-}
-
-// Animation selector jumptable implementation
+// Animation selector, starts the scene selected over MQTT
 void Animation::select() {
-  static void (*jump_table[])() =  //
-      {&SEL_TWINKEL_WHITE_00, &SEL_TWINKEL_MQTT_00, &SEL_FLUX_00,
-       &SEL_TRAILS_HUE_00, &SEL_TWINKEL_MULTI_00};
-  if (config.network.mqtt_values.scene >= sizeof(jump_table) / sizeof(void *)) {
+  if (config.network.mqtt_values.scene >= Scenes::size(Scenes::SELECT)) {
     next();
   } else {
-    jump_table[config.network.mqtt_values.scene]();
+    start(Scenes::SELECT, config.network.mqtt_values.scene);
   }
   config.network.mqtt_values.scene = -1;
-}
\ No newline at end of file
+}
@@ -2,13 +2,29 @@
 #define ANIMATION_H
 #include <stdint.h>
 
+#include "ArduinoJson.h"
 #include "FastLED.h"
+#include "Scenes.h"
 #include "core/Display.h"
+#include "core/Layer.h"
 #include "main.h"
+#include "power/Arena.h"
 #include "power/Noise.h"
 #include "power/Timer.h"
 /*------------------------------------------------------------------------------
  * ANIMATION INTERFACE
+ *------------------------------------------------------------------------------
+ * Base of all animations and the scheduler running them. Animations are found
+ * through the type list in Animations.h instead of virtual functions, every
+ * animation provides:
+ *
+ * static constexpr const char *NAME   name used in the scene files
+ * static bool defaults(JsonObjectConst o, Scene &s)
+ *                                     optional, scene defaults and own keys,
+ *                                     false when a key is out of range
+ * void start(const Scene &scene)      start with the parameters of a scene
+ * void draw(float dt)                 draw a frame into layer
+ * void release()                      optional, return leased memory
  *----------------------------------------------------------------------------*/
 // Task mode, mutually exclusive
 enum class task_state_t { INACTIVE = 0, STARTING = 1, RUNNING = 2, ENDING = 3 };
@@ -27,9 +43,10 @@ class Animation {
   uint16_t hue16 = 0;
   // Animation is active and drawn on the display
   task_state_t task = task_state_t::INACTIVE;
+  // Pixels drawn by this animation, composited onto the display
+  Layer layer;
 
  public:
-  virtual ~Animation(){};
   // Start displaying animations
   static void begin();
   // Animate all active animations
@@ -38,10 +55,25 @@ class Animation {
   static void next();
   // select animations from sequence
   static void select();
-  // Draws antimation frame respecting elapsed time
-  virtual void draw(float dt) = 0;
-  // Gracefully terminate animation
-  virtual void end() = 0;
+  // Stop all animations and start scene index of a list
+  static void start(Scenes::list_t list, uint8_t index);
+  // Terminate animation immediately
+  void stop() { task = task_state_t::INACTIVE; }
+  // Scene defaults of animations without their own, runs until replaced
+  static bool defaults(JsonObjectConst, Scene &s) {
+    s.duration = 0;
+    s.speed[0] = 0;
+    s.speed[1] = 0;
+    return true;
+  }
+  // Return leased memory, called whenever the animation becomes inactive.
+  // The layer is released afterwards and leased black again on the next start.
+  void release() {}
+  // Set how this animation is combined with the animations below it
+  void blend(blend_t mode, uint8_t opacity = 255) {
+    layer.blend = mode;
+    layer.opacity = opacity;
+  }
   // Get current fps
   static float fps();
 };
@@ -0,0 +1,16 @@
+#ifndef ANIMATIONS_H
+#define ANIMATIONS_H
+
+#include "Flux.h"
+#include "Registry.h"
+#include "Trails.h"
+#include "Twinkels.h"
+/*------------------------------------------------------------------------------
+ * ANIMATION LIST
+ *------------------------------------------------------------------------------
+ * All animations that can be started from a scene. They are composited in
+ * this order, the first animation is the bottom layer. A new animation only
+ * needs to be added here.
+ *----------------------------------------------------------------------------*/
+typedef Registry<Flux, Twinkels, Trails> Animations;
+#endif
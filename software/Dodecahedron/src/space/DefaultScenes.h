@@ -0,0 +1,30 @@
+// Generated by scripts/scenes.py from data/scenes.json, do not edit
+#ifndef DEFAULT_SCENES_H
+#define DEFAULT_SCENES_H
+// Built in scenes, used when there is no valid data/scenes.json on SPIFFS
+static const char DEFAULT_SCENES[] = R"({
+  "sequence": [
+    [{"animation": "twinkels", "color": "custom", "rgb": [255, 150, 30], "clear": true}],
+    [{"animation": "twinkels", "color": "mqtt"}],
+    [{"animation": "twinkels", "color": "light", "light": 0}],
+    [{"animation": "twinkels", "color": "light", "light": 1}],
+    [{"animation": "twinkels", "color": "light", "light": 2}],
+    [{"animation": "twinkels", "color": "light", "light": 3}],
+    [{"animation": "twinkels", "color": "light", "light": 4}],
+    [{"animation": "twinkels", "color": "light", "light": 5}],
+    [{"animation": "twinkels", "color": "lights"}],
+    [{"animation": "twinkels", "color": "random", "rise": 0.5, "decay": 1.0}],
+    [{"animation": "trails", "fade_out": true}],
+    [{"animation": "flux"}],
+    [{"animation": "flux", "opacity": 96},
+     {"animation": "trails", "fade_out": true, "blend": "max"}]
+  ],
+  "select": [
+    [{"animation": "twinkels", "duration": 0, "color": "custom", "rgb": [255, 150, 30], "clear": true}],
+    [{"animation": "twinkels", "duration": 0, "color": "mqtt"}],
+    [{"animation": "flux", "duration": 0}],
+    [{"animation": "trails", "duration": 0, "fade_out": true}],
+    [{"animation": "twinkels", "duration": 0, "color": "lights"}]
+  ]
+})";
+#endif
@@ -2,17 +2,21 @@
 #define FLUX_H
 
 #include "Animation.h"
+#include "core/Parallel.h"
 #include "Palettes.h"
 
 class Flux : public Animation {
+ public:
+  static constexpr const char *NAME = "flux";
+
  private:
   // amount of time this animation keeps running
   Timer timer_duration = 60.0f;
   // Color options
   Palettes palettes;
   CRGBPalette16 palette;
-  // Conversion from coordinates to hues
-  uint16_t hues[Display::PIXELS];
+  // Conversion from coordinates to hues, leased while running
+  uint16_t *hues = nullptr;
   // Rotating hue
   uint8_t hue = 0;
   // Brightness used for fading
@@ -23,21 +27,39 @@ class Flux : public Animation {
   boolean mode_fade_out = true;
 
  public:
-  void init(float duration, uint16_t mx, uint16_t my, uint16_t mz) {
+  void init(float duration, uint16_t mx, uint16_t my, uint16_t mz,
+            int8_t palette_index = -1) {
+    if (hues == nullptr) hues = Arena::lease<uint16_t>(Display::PIXELS);
+    if (hues == nullptr) {
+      Serial.println("Flux: out of arena memory");
+      return;
+    }
     task = task_state_t::RUNNING;
     timer_duration = duration;
     for (uint16_t l = 0; l < Display::PIXELS; l++) {
-      hues[l] = (mx * Display::coordinates[l].x) +
-                (my * Display::coordinates[l].y) +
-                (mz * Display::coordinates[l].z);
+      hues[l] = Display::coordinates.dot(l, mx, my, mz) >>
+                Coordinates<Display::PIXELS>::SHIFT;
     }
     brightness = 0;
-    palette = palettes.get_next_palette();
+    if (palette_index < 0)
+      palette = palettes.get_next_palette();
+    else
+      palette = palettes.get_palette(palette_index);
   }
 
-  void end() {
-    mode_fade_out = true;
-    task = task_state_t::ENDING;
+  // Scene defaults from the config
+  static bool defaults(JsonObjectConst, Scene &s) {
+    s.duration = config.flux.timer_duration;
+    return true;
+  }
+  void start(const Scene &s) {
+    init(s.duration, s.movement[0], s.movement[1], s.movement[2], s.palette);
+    blend(s.blend, s.opacity);
+  }
+
+  void release() {
+    Arena::release(hues);
+    hues = nullptr;
   }
 
   void draw(float dt) {
@@ -56,9 +78,9 @@ class Flux : public Animation {
         brightness--;
       }
     }
-    for (uint16_t x = 0; x < Display::PIXELS; x++) {
-      Display::leds[x] = ColorFromPalette(palette, hues[x] + hue, brightness);
-    }
+    Parallel::each(Display::PIXELS, [&](uint16_t x) {
+      layer.leds[x] = ColorFromPalette(palette, hues[x] + hue, brightness);
+    });
     hue++;
   }
 };
@@ -364,4 +364,8 @@ CRGBPalette16 Palettes::get_next_palette() {
     m_palette_index = 0;
   }
   return palette_list[m_palette_index++];
-}
\ No newline at end of file
+}
+
+CRGBPalette16 Palettes::get_palette(uint8_t index) {
+  return palette_list[index % m_palette_count];
+}
@@ -13,5 +13,6 @@ class Palettes {
  public:
   Palettes();
   CRGBPalette16 get_next_palette();
+  CRGBPalette16 get_palette(uint8_t index);
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef REGISTRY_H
+#define REGISTRY_H
+#include <stdint.h>
+#include <string.h>
+
+#include <tuple>
+#include <type_traits>
+/*------------------------------------------------------------------------------
+ * REGISTRY TEMPLATE
+ *------------------------------------------------------------------------------
+ * Holds one instance of every animation type in the list. each() unrolls into
+ * a call per animation at compile time, f is called with the concrete type
+ * so draw() and friends are resolved statically and can be inlined.
+ *
+ * Every animation type provides a NAME used by the scene files:
+ * Registry<Flux, Twinkels> animations;
+ * animations.each([](auto &animation, uint8_t index) { ... });
+ * Registry<Flux, Twinkels>::visit_type(index, [](auto *type) { ... });
+ *----------------------------------------------------------------------------*/
+template <class... A>
+class Registry {
+ public:
+  static const uint8_t SIZE = sizeof...(A);
+
+ private:
+  std::tuple<A...> animations;
+
+  template <uint8_t I, class F>
+  typename std::enable_if<(I == SIZE)>::type unroll(F &) {}
+  template <uint8_t I, class F>
+  typename std::enable_if<(I < SIZE)>::type unroll(F &f) {
+    f(std::get<I>(animations), I);
+    unroll<I + 1>(f);
+  }
+  template <uint8_t I, class F>
+  static typename std::enable_if<(I == SIZE)>::type unroll(uint8_t, F &) {}
+  template <uint8_t I, class F>
+  static typename std::enable_if<(I < SIZE)>::type unroll(uint8_t index,
+                                                          F &f) {
+    typedef typename std::tuple_element<I, std::tuple<A...>>::type T;
+    if (I == index) f((T *)nullptr);
+    unroll<I + 1>(index, f);
+  }
+
+ public:
+  // Call f(animation, index) for every animation in list order
+  template <class F>
+  void each(F f) {
+    unroll<0>(f);
+  }
+  // Call f(animation) for the animation at index
+  template <class F>
+  void visit(uint8_t index, F f) {
+    each([&](auto &animation, uint8_t i) {
+      if (i == index) f(animation);
+    });
+  }
+  // Call f((Animation *)nullptr) with the type of the animation at index,
+  // for static members when there is no instance at hand
+  template <class F>
+  static void visit_type(uint8_t index, F f) {
+    unroll<0>(index, f);
+  }
+  // Name of the animation at index
+  static const char *name(uint8_t index) {
+    static const char *const names[] = {A::NAME...};
+    return index < SIZE ? names[index] : "";
+  }
+  // Index of the animation called name, SIZE if there is none
+  static uint8_t find(const char *name) {
+    for (uint8_t i = 0; i < SIZE; i++) {
+      if (strcmp(name, Registry::name(i)) == 0) return i;
+    }
+    return SIZE;
+  }
+};
+#endif
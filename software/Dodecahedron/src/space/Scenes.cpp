@@ -0,0 +1,122 @@
+#include "Scenes.h"
+
+#include <type_traits>
+
+#include "Animations.h"
+#include "ArduinoJson.h"
+#include "DefaultScenes.h"
+#include "main.h"
+/*------------------------------------------------------------------------------
+ * SCENES STATIC DEFINITIONS
+ *----------------------------------------------------------------------------*/
+Scene Scenes::entries[ENTRIES];
+uint8_t Scenes::first[2][SCENES + 1];
+uint8_t Scenes::count[2];
+/*----------------------------------------------------------------------------*/
+// Find name in a list of names, returns the index or fallback
+static uint8_t lookup(const char *name, const char *const names[], uint8_t n,
+                      uint8_t fallback) {
+  for (uint8_t i = 0; i < n; i++) {
+    if (strcmp(name, names[i]) == 0) return i;
+  }
+  return fallback;
+}
+
+// Read an integer key into value, false when it is outside lo to hi
+template <class T>
+static bool number(JsonVariantConst v, long fallback, long lo, long hi,
+                   T &value) {
+  long n = v | fallback;
+  if (n < lo || n > hi) return false;
+  value = n;
+  return true;
+}
+
+// Fill a scene from a JSON object, missing keys use the config defaults.
+// Values that do not fit their field reject the entry.
+static bool entry(JsonObjectConst o, Scene &s) {
+  static const char *const blends[] = {"add", "max", "alpha", "multiply"};
+  static const char *const colors[] = {"lights", "custom", "mqtt", "light",
+                                       "random"};
+  static const char *const curves[] = {"linear", "ease", "decay", "sparkle"};
+  const char *name = o["animation"] | "";
+  s.animation = Animations::find(name);
+  if (s.animation == Animations::SIZE) return false;
+  bool valid = true;
+  Animations::visit_type(s.animation, [&](auto *type) {
+    valid = std::remove_pointer<decltype(type)>::type::defaults(o, s);
+  });
+  if (!valid) return false;
+  s.duration = o["duration"] | s.duration;
+  if (s.duration < 0) return false;
+  s.fade_out = o["fade_out"] | false;
+  s.blend = (blend_t)lookup(o["blend"] | "add", blends, 4, 0);
+  s.clear = o["clear"] | false;
+  s.color = (color_t)lookup(o["color"] | "lights", colors, 5, 0);
+  s.curve = (curve_t)lookup(o["curve"] | "linear", curves, 4, 0);
+  JsonArrayConst rgb = o["rgb"];
+  JsonArrayConst movement = o["movement"];
+  const auto &flux = config.flux;
+  if (!number(o["opacity"], 255, 0, 255, s.opacity) ||
+      !number(o["light"], 0, 0, config.lights.lights - 1, s.light) ||
+      !number(o["wisps"], config.trails.wisps, 0, 0xFFFF, s.wisps) ||
+      !number(o["spread"], config.trails.spread, 0, 100, s.spread) ||
+      !number(rgb[0], 0, 0, 255, s.rgb.r) ||
+      !number(rgb[1], 0, 0, 255, s.rgb.g) ||
+      !number(rgb[2], 0, 0, 255, s.rgb.b) ||
+      !number(movement[0], flux.x_movement, 0, 0xFFFF, s.movement[0]) ||
+      !number(movement[1], flux.y_movement, 0, 0xFFFF, s.movement[1]) ||
+      !number(movement[2], flux.z_movement, 0, 0xFFFF, s.movement[2]) ||
+      !number(o["palette"], -1, -1, 127, s.palette)) {
+    return false;
+  }
+  return true;
+}
+
+bool Scenes::read(const char *json) {
+  DynamicJsonDocument doc(8192);
+  DeserializationError err = deserializeJson(doc, json);
+  if (err) {
+    Serial.printf("Scenes: %s\n", err.c_str());
+    return false;
+  }
+  static const char *const lists[] = {"sequence", "select"};
+  uint8_t n = 0;
+  for (uint8_t l = 0; l < 2; l++) {
+    count[l] = 0;
+    first[l][0] = n;
+    for (JsonArrayConst scene : doc[lists[l]].as<JsonArrayConst>()) {
+      if (count[l] == SCENES) break;
+      for (JsonObjectConst o : scene) {
+        if (n == ENTRIES || !entry(o, entries[n])) {
+          Serial.printf("Scenes: bad entry in %s scene %u\n", lists[l],
+                        count[l]);
+          return false;
+        }
+        n++;
+      }
+      first[l][++count[l]] = n;
+    }
+  }
+  return true;
+}
+
+bool Scenes::load(const char *json) {
+  if (read(json)) return true;
+  defaults();
+  return false;
+}
+
+void Scenes::defaults() {
+  if (!read(DEFAULT_SCENES)) {
+    count[SEQUENCE] = 0;
+    count[SELECT] = 0;
+  }
+}
+
+uint8_t Scenes::size(list_t list) { return count[list]; }
+
+const Scene *Scenes::get(list_t list, uint8_t scene, uint8_t &n) {
+  n = first[list][scene + 1] - first[list][scene];
+  return &entries[first[list][scene]];
+}
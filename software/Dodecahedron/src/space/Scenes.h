@@ -0,0 +1,89 @@
+#ifndef SCENES_H
+#define SCENES_H
+#include <stdint.h>
+
+#include "FastLED.h"
+#include "core/Layer.h"
+#include "power/Envelope.h"
+/*------------------------------------------------------------------------------
+ * SCENES CLASS
+ *------------------------------------------------------------------------------
+ * Scenes are loaded once at boot from a JSON description into flat tables, so
+ * starting a scene is a table lookup. There are two lists: the sequence that
+ * plays when nothing is selected and the scenes selectable over MQTT.
+ *
+ * A scene starts one or more animations, each described by an object:
+ * {
+ *   "sequence": [
+ *     [{"animation": "twinkels", "color": "light", "light": 2}],
+ *     [{"animation": "flux", "opacity": 96},
+ *      {"animation": "trails", "blend": "max"}]
+ *   ],
+ *   "select": [[{"animation": "flux", "duration": 0}]]
+ * }
+ *
+ * Keys for all animations, missing keys use the defaults in config:
+ * animation  name of an animation in Animations.h
+ * duration   seconds the animation runs, 0 runs until another scene starts
+ * fade_out   fade out gracefully when the duration has passed
+ * blend      "add", "max", "alpha" or "multiply", opacity 0 to 255
+ *
+ * Twinkels:  color "custom" with rgb [r, g, b], "mqtt", "light" with light n,
+ *            "random" or "lights", rise and decay in seconds, clear, curve
+ *            "linear", "ease", "decay" or "sparkle"
+ * Trails:    interval in seconds between moves, fade amount per frame, wisps
+ *            amount, spread of the wisp speeds in percent
+ * Flux:      movement [x, y, z], palette index or -1 for the next one
+ *----------------------------------------------------------------------------*/
+enum class color_t : uint8_t { LIGHTS, CUSTOM, MQTT, LIGHT, RANDOM };
+
+// Parameters to start one animation
+struct Scene {
+  // Index in Animations
+  uint8_t animation;
+  float duration;
+  boolean fade_out;
+  blend_t blend;
+  uint8_t opacity;
+  // Twinkels rise and decay time, Trails interval and fade amount
+  float speed[2];
+  // Twinkels
+  boolean clear;
+  color_t color;
+  uint8_t light;
+  CRGB rgb;
+  curve_t curve;
+  // Trails
+  uint16_t wisps;
+  uint8_t spread;
+  // Flux
+  uint16_t movement[3];
+  int8_t palette;
+};
+
+class Scenes {
+ public:
+  enum list_t { SEQUENCE = 0, SELECT = 1 };
+  static const uint8_t SCENES = 32;
+  static const uint8_t ENTRIES = 64;
+
+ private:
+  // All animation starts of all scenes of both lists
+  static Scene entries[ENTRIES];
+  // Scene s of list l starts entries first[l][s] to first[l][s + 1]
+  static uint8_t first[2][SCENES + 1];
+  static uint8_t count[2];
+  // Parse a JSON description into the tables
+  static bool read(const char *json);
+
+ public:
+  // Parse a JSON description, falls back to the built in scenes on errors
+  static bool load(const char *json);
+  // Load the built in scenes
+  static void defaults();
+  // Amount of scenes in a list
+  static uint8_t size(list_t list);
+  // Animation starts of a scene, n is set to the amount of entries
+  static const Scene *get(list_t list, uint8_t scene, uint8_t &n);
+};
+#endif
@@ -4,6 +4,9 @@
 #include "Animation.h"
 
 class Test : public Animation {
+ public:
+  static constexpr const char *NAME = "test";
+
  private:
   // amount of time this animation keeps running
   Timer timer_duration = 60.0f;
@@ -17,16 +20,17 @@ class Test : public Animation {
     task = task_state_t::RUNNING;
     timer_duration = duration;
   }
-  void end() {
-    mode_fade_out = true;
-    task = task_state_t::ENDING;
+  static bool defaults(JsonObjectConst, Scene &s) {
+    s.duration = 60.0f;
+    return true;
   }
+  void start(const Scene &s) { init(s.duration); }
   void draw(float dt) {
     if (timer_duration.update()) {
       task = task_state_t::INACTIVE;
     }
     delay(10);
-    Display::leds[0].red++;
+    layer.leds[0].red++;
   }
 };
 #endif
\ No newline at end of file
@@ -5,43 +5,78 @@
 #include "FastLED.h"
 
 class Trails : public Animation {
+ public:
+  static constexpr const char *NAME = "trails";
+
  private:
   // amount of time this animation keeps running
   Timer timer_duration = 20.0f;
-  // amount of seconds before moving
-  Timer timer_interval = 0.01f;
+  // leds per second a wisp moves and how much that differs per wisp, percent
+  float wisp_speed = 45.0f;
+  uint8_t speed_spread = 0;
   // amount of fading each frame
   uint8_t fade_out_amount = 5;
-  // max amount of wisps
-  static const uint16_t WISPS = 10;
-  Display::Wisp Wisps[WISPS];
+  // wisps, leased while running
+  Display::WispSwarm swarm;
 
  private:
   // different animation modes
   boolean mode_fade_out = true;
 
+  // Speed of a new wisp in leds per second
+  uint16_t velocity() {
+    float v = wisp_speed *
+              (100 + random(-speed_spread, speed_spread + 1)) / 100;
+    return v < 1 ? 1 : v > 0xFFFF ? 0xFFFF : v;
+  }
+
  public:
   void init(float duration, boolean fade_out = false) {
     task = task_state_t::RUNNING;
     timer_duration = duration;
     mode_fade_out = fade_out;
-    for (int x = 0; x < config.lights.lights; x++) {
-      CRGB color = CHSV(config.lights.light[x].hue >> 8,
-                        config.lights.light[x].sat, 255);
-      Wisps[x].init(x & 1, 0, 0, 0, color);
+    layer.clear();
+    swarm.clear();
+  }
+
+  // Set the amount of wisps, growing the pool when needed. New wisps take the
+  // colors of the lights and start spread over the edges.
+  void wisps(uint16_t n) {
+    if (n < swarm.size()) swarm.clear();
+    if (!swarm.grow(n)) Serial.println("Trails: out of arena memory");
+    for (uint16_t x = swarm.size(); x < n; x++) {
+      const uint8_t light = x % config.lights.lights;
+      CRGB color = CHSV(config.lights.light[light].hue >> 8,
+                        config.lights.light[light].sat, 255);
+      const uint8_t edge = (x / Display::DODECAHEDRA) % Display::EDGES;
+      swarm.add(x % Display::DODECAHEDRA, edge, 0, 0, color, velocity());
     }
   }
 
-  void speed(float interval, float out_amount) {
-    timer_interval = interval;
+  void speed(float interval, float out_amount, uint8_t spread = 0) {
+    wisp_speed = interval > 0 ? 1.0f / interval : 0xFFFF;
+    speed_spread = spread > 100 ? 100 : spread;
     fade_out_amount = out_amount;
+    for (uint16_t i = 0; i < swarm.size(); i++) swarm.speed(i) = velocity();
+  }
+  // Scene defaults from the config, overridden by the keys in o
+  static bool defaults(JsonObjectConst o, Scene &s) {
+    s.duration = config.trails.timer_duration;
+    s.speed[0] = o["interval"] | config.trails.timer_interval;
+    s.speed[1] = o["fade"] | (float)config.trails.fade_out_amount;
+    // the fade amount is 8 bit
+    return s.speed[0] >= 0 && s.speed[1] >= 0 && s.speed[1] <= 255;
   }
-  void end() {
-    mode_fade_out = true;
-    task = task_state_t::ENDING;
+  void start(const Scene &s) {
+    init(s.duration, s.fade_out);
+    speed(s.speed[0], s.speed[1], s.spread);
+    wisps(s.wisps);
+    blend(s.blend, s.opacity);
   }
+  void release() { swarm.release(); }
+
   void draw(float dt) {
-    Display::fade(fade_out_amount);
+    layer.fade(fade_out_amount);
     if (timer_duration.update()) {
       task = task_state_t::ENDING;
     }
@@ -53,24 +88,19 @@ class Trails : public Animation {
         task = task_state_t::INACTIVE;
       }
     }
-    // only move and draw once per interval
-    if (timer_interval.update()) {
-      uint8_t blacks = 0;
-      for (int x = 0; x < config.lights.lights; x++) {
-        CRGB color = Wisps[x].color;
-        if (fade_active) {
-          color = Display::leds[Wisps[x].led()];
-        }
-        if ((color.red | color.green | color.blue) == 0) {
-          blacks++;
-        }
-        Wisps[x].move();
-        Display::leds[Wisps[x].led()] = color;
-      }
-      if ((task == task_state_t::ENDING) & (blacks == config.lights.lights)) {
-        task = task_state_t::INACTIVE;
+    // when fading out, stop once every wisp carries black
+    if (fade_active) {
+      uint16_t blacks = 0;
+      for (uint16_t i = 0; i < swarm.size(); i++) {
+        CRGB color = layer.leds[swarm.led(i)];
+        if ((color.red | color.green | color.blue) == 0) blacks++;
       }
+      if (blacks == swarm.size()) task = task_state_t::INACTIVE;
     }
+    // paint every led passed, fading wisps carry the color they are on
+    swarm.move(dt, [&](uint16_t i, uint16_t from, uint16_t to) {
+      layer.leds[to] = fade_active ? layer.leds[from] : swarm.color(i);
+    });
   }
 };
-#endif
\ No newline at end of file
+#endif
@@ -4,6 +4,9 @@
 #include "Animation.h"
 #include "FastLED.h"
 class Twinkels : public Animation {
+ public:
+  static constexpr const char *NAME = "twinkels";
+
  private:
   // amount of time this animation keeps running
   Timer timer_duration = 20.0f;
@@ -11,10 +14,36 @@ class Twinkels : public Animation {
   float fade_in_speed = 1.0f;
   // amount of seconds it takes to fade a pixel to min
   float fade_out_speed = 3.0f;
-  // source buffer for origional value
-  CRGB buffer[Display::PIXELS] = {};
-  // amount of time the pixel is activated
-  float time[Display::PIXELS] = {};
+  // State of a pixel, the color is an index in colors
+  struct Twinkle {
+    uint16_t phase;
+    uint8_t color;
+    uint8_t reserved;
+  };
+  static_assert(sizeof(Twinkle) == 4, "Twinkle state is packed in 4 bytes");
+  // state of each pixel, leased while running
+  Twinkle *twinkles = nullptr;
+  // colors twinkles can take in this scene, refreshed every frame from their
+  // source so lights and mqtt changes show on the running twinkles
+  static const uint8_t COLORS = 64;
+  CRGB colors[COLORS];
+  // brightness curve of a twinkle
+  Envelope envelope;
+  // bit per pixel that is twinkling and the amount of those, leased while
+  // running so a frame only visits live twinkles
+  static const uint16_t WORDS = (Display::PIXELS + 31) / 32;
+  uint32_t *live = nullptr;
+  uint16_t live_count = 0;
+  // most twinkles started in one frame
+  static const uint8_t SPAWNS = 64;
+  // dim / dim_divisor is the amount of twinkles started every 1 / RATE
+  // seconds, independent of the frame rate. Spawns no longer collide, RATE
+  // keeps the density the old per frame loop reached with its collisions.
+  static constexpr float RATE = 22.5f;
+  // twinkles owed to the next frames, what could not start carries over
+  float spawn_credit = 0;
+  // xorshift state for spawning, cheaper than random()
+  uint32_t seed = 0x9E3779B9;
 
  private:
   // different animation modes
@@ -32,6 +61,16 @@ class Twinkels : public Animation {
   void init(float duration, boolean single = false, boolean custom = false,
             boolean fade_out = false, boolean rnd = false,
             boolean mqtt = false) {
+    if (twinkles == nullptr) {
+      twinkles = Arena::lease<Twinkle>(Display::PIXELS);
+      live = Arena::lease<uint32_t>(WORDS);
+      live_count = 0;
+    }
+    if (twinkles == nullptr || live == nullptr) {
+      Serial.println("Twinkels: out of arena memory");
+      release();
+      return;
+    }
     task = task_state_t::RUNNING;
     timer_duration = duration;
     mode_single_color = single;
@@ -39,6 +78,13 @@ class Twinkels : public Animation {
     mode_custom_color = custom;
     mode_mqtt_color = mqtt;
     mode_random_color = rnd;
+    spawn_credit = 0;
+    seed = random(1, 0x7FFFFFFF);
+    if (rnd) {
+      for (uint8_t i = 0; i < COLORS; i++) {
+        colors[i] = CRGB(random(0, 255), random(0, 255), random(0, 255));
+      }
+    }
   }
   void speed(float in_speed, float out_speed) {
     fade_in_speed = in_speed;
@@ -46,40 +92,139 @@ class Twinkels : public Animation {
   }
   void color(CRGB c) { custom_color = c; }
   void color(uint8_t light) { hue_light = light; }
+  void curve(curve_t c) { envelope.shape(c); }
   void clear() {
-    for (uint16_t x = 0; x < Display::PIXELS; x++) {
-      time[x] = 0;
-      buffer[x] = CRGB(0, 0, 0);
+    if (twinkles == nullptr) return;
+    memset(twinkles, 0, Display::PIXELS * sizeof(Twinkle));
+    for (uint16_t w = 0; w < WORDS; w++) live[w] = 0;
+    live_count = 0;
+    layer.clear();
+  }
+
+  // Scene defaults from the config, overridden by the keys in o
+  static bool defaults(JsonObjectConst o, Scene &s) {
+    s.duration = config.twinkels.timer_duration;
+    s.speed[0] = o["rise"] | config.twinkels.fade_in_speed;
+    s.speed[1] = o["decay"] | config.twinkels.fade_out_speed;
+    return s.speed[0] >= 0 && s.speed[1] >= 0;
+  }
+  void start(const Scene &s) {
+    boolean custom = s.color == color_t::CUSTOM;
+    boolean mqtt = s.color == color_t::MQTT;
+    boolean single = custom || mqtt || s.color == color_t::LIGHT;
+    if (s.clear) clear();
+    init(s.duration, single, custom, s.fade_out, s.color == color_t::RANDOM,
+         mqtt);
+    speed(s.speed[0], s.speed[1]);
+    color(s.rgb);
+    color(s.light);
+    curve(s.curve);
+    blend(s.blend, s.opacity);
+  }
+
+  void release() {
+    Arena::release(twinkles);
+    Arena::release(live);
+    twinkles = nullptr;
+    live = nullptr;
+  }
+
+  // Refresh the colors of the sources that change at runtime
+  void resolve() {
+    if (mode_single_color) {
+      if (mode_custom_color)
+        colors[0] = custom_color;
+      else if (mode_mqtt_color)
+        colors[0] = config.network.mqtt_values.color;
+      else
+        colors[0] = CHSV(config.lights.light[hue_light].hue >> 8,
+                         config.lights.light[hue_light].sat, 255);
+    } else if (!mode_random_color) {
+      for (uint8_t i = 0; i < config.lights.lights; i++) {
+        colors[i] = CHSV(config.lights.light[i].hue >> 8,
+                         config.lights.light[i].sat, 255);
+      }
     }
   }
 
-  void end() {
-    mode_fade_out = true;
-    task = task_state_t::ENDING;
+  // Start up to n twinkles on distinct pixels that are not twinkling,
+  // returns the amount started
+  uint16_t spawn(uint16_t n) {
+    uint16_t free = Display::PIXELS - live_count;
+    if (n > free) n = free;
+    if (n > SPAWNS) n = SPAWNS;
+    if (n == 0) return 0;
+    uint32_t s = seed;
+    // Floyd's sampling of n distinct ranks among the free pixels, sorted
+    uint16_t ranks[SPAWNS];
+    for (uint16_t j = free - n, k = 0; j < free; j++, k++) {
+      s ^= s << 13;
+      s ^= s >> 17;
+      s ^= s << 5;
+      uint16_t r = ((uint64_t)s * (j + 1)) >> 32;
+      uint16_t i = 0;
+      while (i < k && ranks[i] < r) i++;
+      if (i < k && ranks[i] == r) {
+        // taken, j is larger than all ranks so far
+        r = j;
+        i = k;
+      }
+      for (uint16_t m = k; m > i; m--) ranks[m] = ranks[m - 1];
+      ranks[i] = r;
+    }
+    // Find the pixel of each rank in one pass over the free bits
+    uint16_t k = 0;
+    uint16_t first = 0;
+    for (uint16_t w = 0; w < WORDS && k < n; w++) {
+      uint32_t bits = ~live[w];
+      if (w == WORDS - 1 && Display::PIXELS % 32)
+        bits &= (1UL << (Display::PIXELS % 32)) - 1;
+      uint16_t count = __builtin_popcount(bits);
+      for (; k < n && ranks[k] < first + count; k++) {
+        uint32_t b = bits;
+        for (uint16_t r = ranks[k] - first; r > 0; r--) b &= b - 1;
+        uint16_t x = w * 32 + __builtin_ctz(b);
+        uint8_t color = 0;
+        if (!mode_single_color) {
+          s ^= s << 13;
+          s ^= s >> 17;
+          s ^= s << 5;
+          color = ((uint64_t)s *
+                   (mode_random_color ? COLORS : config.lights.lights)) >>
+                  32;
+        }
+        twinkles[x].color = color;
+        // black twinkles are not lit and need no drawing
+        if (colors[color].r | colors[color].g | colors[color].b) {
+          live[w] |= 1UL << (x % 32);
+          live_count++;
+        }
+      }
+      first += count;
+    }
+    seed = s;
+    return n;
   }
 
   void draw(float dt) {
-    bool pixels_active = false;
-    for (uint16_t x = 0; x < Display::PIXELS; x++) {
-      if (buffer[x].r | buffer[x].g | buffer[x].b) {
-        if (time[x] < fade_in_speed) {
-          float t = time[x] / fade_in_speed;
-          CRGB c = buffer[x];
-          nscale8x3(c.r, c.g, c.b, (uint8_t)(255 * t));
-          Display::leds[x] = c;
-          time[x] += dt;
-        } else if (time[x] < fade_in_speed + fade_out_speed) {
-          float t = (time[x] - fade_in_speed) / fade_out_speed;
-          CRGB c = buffer[x];
-          nscale8x3(c.r, c.g, c.b, (uint8_t)(255 * (1 - t)));
-          Display::leds[x] = c;
-          time[x] += dt;
-        } else {
-          time[x] = 0;
-          buffer[x] = CRGB(0, 0, 0);
-          Display::leds[x] = CRGB(0, 0, 0);
+    resolve();
+    envelope.frame(fade_in_speed, fade_out_speed, dt);
+    for (uint16_t w = 0; w < WORDS; w++) {
+      uint32_t bits = live[w];
+      while (bits) {
+        uint8_t b = 31 - __builtin_clz(bits);
+        bits &= ~(1UL << b);
+        uint16_t x = w * 32 + b;
+        Twinkle &t = twinkles[x];
+        CRGB c = colors[t.color];
+        nscale8x3(c.r, c.g, c.b, envelope.level(t.phase));
+        layer.leds[x] = c;
+        if (!envelope.step(t.phase)) {
+          t.phase = 0;
+          layer.leds[x] = CRGB(0, 0, 0);
+          live[w] &= ~(1UL << b);
+          live_count--;
         }
-        pixels_active = true;
       }
     }
     // if this animation is finished start end mode
@@ -87,38 +232,14 @@ class Twinkels : public Animation {
       task = task_state_t::ENDING;
     }
     if (task != task_state_t::ENDING) {
-      const uint8_t div = config.twinkels.dim_divisor;
-      const uint8_t dim = config.network.mqtt_values.dim;
-      uint8_t counter = ceil(dim / (float)div);
-      uint8_t chance = (counter * div) - dim;
-      // Consider adding a new random twinkle
-      for (int i = 0; i < counter; i++) {
-        if ((i == counter - 1) && (random(0, div) < chance)) {
-          break;
-        }
-        uint16_t x = random(0, Display::PIXELS);
-        if (time[x] == 0) {
-          if (mode_single_color) {
-            if (mode_custom_color)
-              buffer[x] = custom_color;
-            else if (mode_mqtt_color)
-              buffer[x] = config.network.mqtt_values.color;
-            else
-              buffer[x] = CHSV(config.lights.light[hue_light].hue >> 8,
-                               config.lights.light[hue_light].sat, 255);
-
-          } else if (mode_random_color) {
-            buffer[x] = CRGB(random(0, 255), random(0, 255), random(0, 255));
-          } else {
-            uint8_t light = random(0, config.lights.lights);
-            buffer[x] = CHSV(config.lights.light[light].hue >> 8,
-                             config.lights.light[light].sat, 255);
-          }
-        }
-      }
+      spawn_credit += config.network.mqtt_values.dim * RATE /
+                      config.twinkels.dim_divisor * dt;
+      // never owe more than the display can show at once
+      if (spawn_credit > Display::PIXELS) spawn_credit = Display::PIXELS;
+      spawn_credit -= spawn(spawn_credit);
     } else if (mode_fade_out) {
       // deactivate when all pixels are black
-      if (!pixels_active) {
+      if (live_count == 0) {
         task = task_state_t::INACTIVE;
       }
     } else {